@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-07T08:04:51-0500
- * @date Last modified: 2014-01-12T16:20:18-0500
+ * @date Last modified: 2026-10-20T11:48:12-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -23,19 +23,95 @@
 #ifndef _LCD_H
 #define _LCD_H
 
+/**
+ @def LCD_ROWS
+ @brief Number of rows on the display, 2 or 4.
+ @def LCD_COLS
+ @brief Number of characters in each row of the display, 16 or 20.
+ @details Only the 16x2 and 20x4 geometries have a screen layout in
+ SysTick.c, so only those are accepted.
+ */
+#ifndef LCD_ROWS
+#define LCD_ROWS  2
+#endif
+#ifndef LCD_COLS
+#define LCD_COLS  16
+#endif
+#if !(((LCD_ROWS == 2) && (LCD_COLS == 16)) || \
+      ((LCD_ROWS == 4) && (LCD_COLS == 20)))
+#error "The display must be 16x2 or 20x4"
+#endif
+
 //
 // Number of rows and columns in the display, starting from 0
 //
-#define MAX_ROW 1
-#define MAX_COL 15
+#define MAX_ROW (LCD_ROWS - 1)
+#define MAX_COL (LCD_COLS - 1)
 
+/**
+ @def LCD_I2C_BACKPACK
+ @brief Set to 1 to drive the LCD through a PCF8574 I2C backpack (LCD8574.c)
+ instead of the 4-bit parallel interface (LCD4.c).
+ @details The backpack must be on the same bus as the temperature sensors,
+ and ::I2C_SPEED_HZ must then be 100000. LCD_Init() must be called after
+ I2CInit() and SysTick_Config().
+ */
+#ifndef LCD_I2C_BACKPACK
+#define LCD_I2C_BACKPACK  0
+#endif
+
+/**
+ @def LCD_I2C_ADDR
+ @brief The 8-bit I2C address of the backpack, with all address pins high.
+ @def LCD_PCF_RS
+ @brief The PCF8574 bit wired to the LCD's Register Select pin.
+ @def LCD_PCF_RW
+ @brief The PCF8574 bit wired to the LCD's Read/Write pin.
+ @def LCD_PCF_EN
+ @brief The PCF8574 bit wired to the LCD's Enable pin.
+ @def LCD_PCF_BL
+ @brief The PCF8574 bit that turns on the backlight.
+ @def LCD_PCF_DATA_Pos
+ @brief The PCF8574 bit wired to LCD data bit 4, the next three bits go to
+ data bits 5 to 7.
+ @details These suit the common backpacks; use 0x7E for one with a PCF8574A.
+ */
+#ifndef LCD_I2C_ADDR
+#define LCD_I2C_ADDR      0x4E
+#endif
+#define LCD_PCF_RS        0x01
+#define LCD_PCF_RW        0x02
+#define LCD_PCF_EN        0x04
+#define LCD_PCF_BL        0x08
+#define LCD_PCF_DATA_Pos  4
+
+/**
+ @def LCD_DATA_PORT
+ @brief The GPIO port for the 4 data bits, starting at bit ::LCD_DATA_Pos.
+ @def LCD_CTRL_PORT
+ @brief The GPIO port for RS, RW and EN, starting at bit ::LCD_CTRL_Pos.
+ @details The ports may be defined before this file is included, to point
+ the driver at a model of the GPIO registers when it is built off target.
+ */
 #define LCD_DATA_Pos   6
+#ifndef LCD_DATA_PORT
 #define LCD_DATA_PORT  LPC_GPIO0
+#endif
 #define LCD_CTRL_Pos   1
+#ifndef LCD_CTRL_PORT
 #define LCD_CTRL_PORT  LPC_GPIO0
+#endif
 
-// Approximate clock period, nanoseconds
-#define CLKPER          20   // LPC1114 runs at 48 MHz
+/**
+ @def LCD_DELAY_HOOK
+ @brief Off target, the name of a function that the 4-bit interface calls
+ with the number of delay loops instead of spinning.
+ @details This lets a model of the LCD keep time with the driver. It is
+ never defined for the target.
+ */
+#ifdef LCD_DELAY_HOOK
+void LCD_DELAY_HOOK(uint32_t loops);
+#endif
 
 /**
  @def LCD_TAS
@@ -56,16 +132,74 @@
 #define LCD_TEH        300   // EN minimum high time
 #define LCD_TEL        200   // EN minimum low time
 
-extern char TopLine[MAX_COL+1];
-extern char BottomLine[MAX_COL+1];
+//
+// Data is set up before EN rises and read at the end of the EN high time, so
+// the EN high time must cover both the data setup and the read delay
+//
+#if (LCD_TDS > LCD_TEH) || (LCD_TDA > LCD_TEH)
+#error "LCD_TEH must be at least as long as LCD_TDS and LCD_TDA"
+#endif
+
+/**
+ @def LCD_BAR_STEPS
+ @brief Number of steps that each character cell of a bar graph can show.
+ @details A bar graph cell is blank, has 1 to 4 pixel columns lit, or is
+ completely lit. The partly lit cells are custom characters loaded into the
+ LCD's CGRAM by LCD_Init(), using character codes 1 to 4.
+ */
+#define LCD_BAR_STEPS  5
+
+/**
+ @def TopLine
+ @brief Character string that is written to row 0 of the LCD display.
+ @def BottomLine
+ @brief Character string that is written to row 1 of the LCD display.
+ */
+extern char DisplayLines[MAX_ROW+1][MAX_COL+1];
+#define TopLine     (DisplayLines[0])
+#define BottomLine  (DisplayLines[1])
 //
 // Initializes the display, should be called just once
 //
 void LCD_Init(void);
 //
-// Display the next character, using Row and Col to point to the current
-// character position. TopLine and BottomLine contain the text to be displayed.
+// Display the next character of the published text that differs from what
+// is on the LCD. Does nothing if the LCD is up to date.
 //
 void LCD_WriteNextChar();
+//
+// Publish the text in DisplayLines to the LCD, called from the SysTick
+// handler
+//
+void LCD_Publish(void);
+//
+// Draw a bar graph of fill steps into cells characters of a display string
+//
+void LCD_Bar(char *dest, uint32_t cells, uint32_t fill);
+//
+// Write the next changed character if the LCD is ready, call often from the
+// main loop
+//
+void LCD_Poll(void);
+
+//
+// The interface back end, LCD4.c or LCD8574.c. Only LCD.c should need these.
+//
+// Wake the LCD and put it in 4-bit mode
+//
+void LCD_InitInterface(void);
+//
+// Write a command or a character, without waiting for the LCD
+//
+void LCD_WriteCommandNoWait(uint8_t command);
+void LCD_WriteDataNoWait(uint8_t data);
+//
+// Read the LCD's busy flag, returns true while it is busy
+//
+uint32_t LCD_Busy(void);
+//
+// Wait until the LCD is ready for the next command, including the slow ones
+//
+void Wait_LCD(void);
 
 #endif
@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-07T19:29:34-0500
- * @date Last modified: 2014-01-12T16:18:05-0500
+ * @date Last modified: 2026-10-19T13:25:40-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -30,7 +30,8 @@
  */
 #  define TICKS_PER_SEC  100
 
-extern uint32_t Ticks;
+extern volatile uint32_t Ticks;
+extern volatile uint32_t TickCount;
 
 void SysTick_Handler();
 
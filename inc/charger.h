@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-07T20:02:08-0500
- * @date Last modified: 2014-01-12T17:50:55-0500
+ * @date Last modified: 2026-10-20T13:18:44-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -113,6 +113,78 @@
 #  define MODE3_VOLTAGE_MV   12900
 /**@}*/
 
+/**
+ * @name Temperature compensation
+ * @details The stage voltages above are correct for a battery at
+ * ::TEMP_COMP_REF_C. Lead-acid charging voltages should fall by 3 to 5 mV per
+ * degree C for each cell as the battery warms, so the charger adds an offset
+ * of ::TEMP_COMP_MV_PER_C for every degree below the reference and subtracts
+ * it for every degree above. The temperature used for this is clamped to the
+ * range from ::TEMP_COMP_MIN_C to ::TEMP_COMP_MAX_C, and the compensated
+ * voltages are clamped to the range from ::TEMP_COMP_MIN_MV to
+ * ::TEMP_COMP_MAX_MV. The upper clamp must stay below ::OPEN_VOLTAGE_MV so
+ * that a cold battery is not mistaken for an open circuit.
+ */
+/**@{*/
+#  define TEMP_COMP_REF_C     25
+#  define TEMP_COMP_MV_PER_C  24  // 4 mV/C for each of 6 cells
+#  define TEMP_COMP_MIN_C     (-24)
+#  define TEMP_COMP_MAX_C     56
+#  define TEMP_COMP_MIN_MV    12000
+#  define TEMP_COMP_MAX_MV    14800
+/**@}*/
+
+/**
+ * @name Thermal derating
+ * @details The stage 1 charging current is reduced when the hottest
+ * temperature sensor is predicted to read above ::TEMP_DERATE_START_C. The
+ * current falls in proportion to the predicted temperature, reaching zero at
+ * ::TEMP_DERATE_STOP_C, but the charger keeps running so that the current
+ * can rise again as the battery cools.
+ *
+ * The prediction adds the rise over the last ::TEMP_TREND_SAMPLES samples,
+ * taken every ::TEMP_TREND_SEC seconds, times 2^::TEMP_PREDICT_SHIFT, to the
+ * present temperature. With the values below it looks about two minutes
+ * ahead. A falling temperature is not extrapolated.
+ *
+ * If any sensor actually reaches ::TEMP_FAULT_C the charger stops with an
+ * error. A sensor that stops answering is left out, and if that is the
+ * battery sensor the charger stops, since its temperature also sets the
+ * charging voltages.
+ */
+/**@{*/
+#  define TEMP_DERATE_START_C  45
+#  define TEMP_DERATE_STOP_C   60
+#  define TEMP_TREND_SEC       4
+#  define TEMP_TREND_SAMPLES   16
+#  define TEMP_PREDICT_SHIFT   1
+#  define TEMP_FAULT_C         65
+/**@}*/
+
+/**
+ * @def TEMP_SENSOR_OPTIONAL
+ * @brief Set to 1 to allow charging when no temperature sensor is found.
+ * @details Normally the charger stops with ::FAULT_SENSOR as soon as the
+ * button is pressed if the scan found no sensor. With this set it charges
+ * instead, at the uncompensated voltages and the full current and with no
+ * over-temperature protection, and the display shows "--" for the
+ * temperature.
+ */
+#  ifndef TEMP_SENSOR_OPTIONAL
+#    define TEMP_SENSOR_OPTIONAL  0
+#  endif
+
+/**
+ * @name Event types
+ * @details Temperatures from several sensors use the types from
+ * ::EVENT_TEMPERATURE to ::EVENT_TEMPERATURE_LAST, and the sensor number is
+ * the type minus ::EVENT_TEMPERATURE.
+ */
+/**@{*/
+#  define EVENT_TEMPERATURE       1  ///< Value is a temperature in 1/256 C
+#  define EVENT_TEMPERATURE_LAST  8  ///< Last type used for temperatures
+/**@}*/
+
 /**
  * @name START button connection
  * @details These parameters specify the name of the GPIO port, and the bit
@@ -138,6 +210,28 @@
 #  define FLAG1_Msk          (1 << FLAG1_Pos)
 /**@}*/
 
+/**
+ * @name Interrupt priorities
+ * @details The Cortex-M0 has four interrupt priority levels, where 0 is the
+ * most urgent. Every interrupt that the charger uses is given its priority
+ * here so that the whole scheme can be seen in one place.
+ *
+ * The ADC interrupt runs thousands of times per second and must collect each
+ * sample before the next burst conversion overwrites it, so it has the
+ * highest priority. The watchdog warning interrupt shares that level so it
+ * can always shut down the PWM. The SysTick handler runs the control loop
+ * and must not be delayed by the slower user-interface and sensor paths.
+ * The I2C temperature sensor is the least urgent; the controller simply
+ * stretches the clock until its interrupt is serviced. The UART only
+ * refills its transmit FIFO for telemetry, so it takes whatever time is left.
+ */
+/**@{*/
+#  define ADC_IRQ_PRIORITY      0
+#  define WDT_IRQ_PRIORITY      0
+#  define SYSTICK_IRQ_PRIORITY  1
+#  define I2C_IRQ_PRIORITY      2
+#  define UART_IRQ_PRIORITY     3
+/**@}*/
 
 enum ChargerState {
   /// The ERROR state will be entered when a fault condition is detected.
@@ -174,8 +268,20 @@ enum ChargerState {
   TRICKLE
 };
 
-uint32_t State;
-uint32_t FastVoltage, RawCurrent, RawVoltage;
-uint32_t Temperature;
+/**
+ * @brief The reason that the charger entered the ERROR state.
+ */
+enum ChargerFault {
+  FAULT_NONE = 0,       ///< No fault has been detected
+  FAULT_SHORT,          ///< Battery voltage below ::SHORT_VOLTAGE_MV
+  FAULT_OPEN,           ///< Battery voltage above ::OPEN_VOLTAGE_MV
+  FAULT_WATCHDOG,       ///< A task missed its watchdog deadline
+  FAULT_OVERTEMP,       ///< A temperature sensor reached ::TEMP_FAULT_C
+  FAULT_SENSOR          ///< The battery sensor stopped answering or is missing
+};
+
+extern volatile uint32_t State, Fault;
+extern volatile uint32_t FastVoltage, RawCurrent, RawVoltage;
+extern volatile int32_t Temperature, HottestTemperature;
 
 #endif
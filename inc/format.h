@@ -0,0 +1,61 @@
+/**
+ * @file format.h
+ *
+ * @brief User interface to the number formatting functions.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T19:22:18-0400
+ * @date Last modified: 2026-10-20T15:02:40-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _FORMAT_H_
+#  define _FORMAT_H_
+
+/**
+ * @def FORMAT_MAX
+ * @brief The largest magnitude that can be formatted.
+ * @details It covers every value that a six-character field can show, such
+ * as 99.999 Ah of charge.
+ */
+#  define FORMAT_MAX  163839
+
+/**
+ * @def FORMAT_DIV100_MAX
+ * @brief The largest value that Format_Div100() divides exactly.
+ */
+#  define FORMAT_DIV100_MAX  43698
+
+/**
+ * @name Formatting flags
+ */
+/**@{*/
+#  define FORMAT_ZERO_PAD  1  ///< Fill the field with leading zeros
+/**@}*/
+
+//
+// Divide by 10, for values up to FORMAT_MAX
+//
+uint32_t Format_Div10(uint32_t value);
+//
+// Divide by 100, for values up to FORMAT_DIV100_MAX
+//
+uint32_t Format_Div100(uint32_t value);
+//
+// Write a signed fixed-point number, right-justified in a field
+//
+void Format_Fixed(char *dest, uint32_t width, int32_t value,
+                  uint32_t decimals, uint32_t flags);
+
+#endif
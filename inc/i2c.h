@@ -20,13 +20,52 @@
 #ifndef __I2C_H 
 #define __I2C_H
 
-/* If I2C SEEPROM is tested, make sure FAST_MODE_PLUS is 0.
-For board to board test, this flag can be turned on. */
+/* SCL frequency. Only 100000 (Standard-mode), 400000 (Fast-mode) and
+1000000 (Fast-mode Plus) are supported. Every device on the bus must be
+rated for the speed chosen; the LM75 is rated for Fast-mode, but a PCF8574
+LCD backpack only for Standard-mode. */
+#ifndef I2C_SPEED_HZ
+#define I2C_SPEED_HZ        400000
+#endif
 
-#define FAST_MODE_PLUS      0
+#if (I2C_SPEED_HZ != 100000) && (I2C_SPEED_HZ != 400000) && \
+	(I2C_SPEED_HZ != 1000000)
+#error "I2C_SPEED_HZ must be 100000, 400000 or 1000000"
+#endif
 
-#define BUFSIZE             4
-#define MAX_TIMEOUT         0x00FFFFFF
+#define FAST_MODE_PLUS      (I2C_SPEED_HZ > 400000)
+
+/* Share of each SCL period spent low, in percent. Fast-mode and Fast-mode
+Plus need a longer low time than high time (1.3us low, 0.6us high at
+400 kHz). */
+#ifndef I2C_SCLL_PERCENT
+#if I2C_SPEED_HZ > 100000
+#define I2C_SCLL_PERCENT    60
+#else
+#define I2C_SCLL_PERCENT    50
+#endif
+#endif
+
+/* Shortest SCLH or SCLL count accepted by the controller. If the I2C clock
+is below 2 * I2C_SCL_MIN_COUNT * I2C_SPEED_HZ then SCL runs slower than
+I2C_SPEED_HZ. */
+#define I2C_SCL_MIN_COUNT   4
+
+#if (I2C_SCLL_PERCENT < 50) || (I2C_SCLL_PERCENT > 75)
+#error "I2C_SCLL_PERCENT must be from 50 to 75"
+#endif
+
+/* Set I2C_SLAVE_ENABLE to 1 to let another master on the bus read the
+register map in regmap.h at I2C_SLAVE_ADDR. The charger still acts as a
+master to read its sensors. */
+#ifndef I2C_SLAVE_ENABLE
+#define I2C_SLAVE_ENABLE    0
+#endif
+#define I2C_SLAVE_ADDR      0x60
+
+#define BUFSIZE             5           /* Longest transaction, an LCD write */
+#define I2C_TIMEOUT_MS      20          /* Longest allowed transaction */
+#define I2C_QUEUE_SIZE      4           /* Pending transactions, max */
 
 #define I2CMASTER           0x01
 #define I2CSLAVE            0x02
@@ -63,13 +102,26 @@ For board to board test, this flag can be turned on. */
 
 #define I2DAT_I2C           0x00000000  /* I2C Data Reg */
 #define I2ADR_I2C           0x00000000  /* I2C Slave Address Reg */
-//
-// I2C clock is 62.5kHz when system clock is 48MHz
-//
-#define I2SCLH_SCLH         0x00000180  /* I2C SCL Duty Cycle High Reg */
-#define I2SCLL_SCLL         0x00000180  /* I2C SCL Duty Cycle Low Reg */
-//#define I2SCLH_HS_SCLH		0x00000015  /* Fast Plus I2C SCL Duty Cycle High Reg */
-//#define I2SCLL_HS_SCLL		0x00000015  /* Fast Plus I2C SCL Duty Cycle Low Reg */
+
+/*
+A transaction writes WriteLength bytes and then, after a repeated start,
+reads ReadLength bytes. Either length may be zero. Address is the 8-bit
+slave address with the R/W bit clear. Status is I2C_BUSY until the
+transaction is done, then I2C_OK or one of the error states, and Callback
+(if not null) is then called from the interrupt handler. A transaction that
+times out is finished by I2CCheckTimeout() instead, which calls Callback
+from the main loop with the I2C interrupt disabled.
+*/
+typedef struct I2CTransaction
+{
+  uint8_t Address;
+  uint8_t WriteLength;
+  uint8_t ReadLength;
+  uint8_t WriteData[BUFSIZE];
+  volatile uint8_t ReadData[BUFSIZE];
+  volatile uint32_t Status;
+  void (*Callback)( struct I2CTransaction *t );
+} I2CTransaction;
 
 extern volatile uint8_t I2CMasterBuffer[BUFSIZE];
 extern volatile uint8_t I2CSlaveBuffer[BUFSIZE];
@@ -81,6 +133,17 @@ extern uint32_t I2CInit( uint32_t I2cMode );
 extern uint32_t I2CStart( void );
 extern uint32_t I2CStop( void );
 extern uint32_t I2CEngine( void );
+extern uint32_t I2CSubmit( I2CTransaction *t );
+extern uint32_t I2CCheckTimeout( void );
+
+/* Number of transactions that ended with each status, I2C_OK and errors */
+extern volatile uint32_t I2CStatusCount[I2C_OK + 1];
+/* Number of times a stuck bus was cleared */
+extern volatile uint32_t I2CBusRecoveries;
+/* Number of data bytes moved as master, for throughput with TickCount:
+the sum of I2CStatusCount[] gives transactions, and differences of both
+counters over a known number of ticks give the rates */
+extern volatile uint32_t I2CByteCount;
 
 #endif /* end __I2C_H */
 /****************************************************************************
@@ -0,0 +1,84 @@
+/**
+ * @file jitter.h
+ *
+ * @brief User interface to the interrupt latency measurement functions.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T10:02:17-0400
+ * @date Last modified: 2026-10-19T10:02:17-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _JITTER_H_
+#  define _JITTER_H_
+
+/**
+ * @def JITTER_MEASUREMENT
+ * @brief Set to 1 to measure interrupt latency.
+ * @details The measurement code is only compiled in when this is non-zero,
+ * so it costs nothing in normal builds. It may be set on the compiler command
+ * line with <tt>-DJITTER_MEASUREMENT=1</tt>. Timer CT32B0 is used as a
+ * free-running cycle counter while this mode is enabled.
+ */
+#  ifndef JITTER_MEASUREMENT
+#    define JITTER_MEASUREMENT 0
+#  endif
+
+/**
+ * @name Measured interrupts
+ * @details Index values for the ::Jitter array.
+ */
+/**@{*/
+#  define JITTER_SYSTICK      0
+#  define JITTER_ADC          1
+#  define JITTER_I2C          2
+#  define JITTER_NUM_SOURCES  3
+/**@}*/
+
+/**
+ * @def JITTER_BUCKETS
+ * @brief Number of histogram buckets for each interrupt.
+ * @details Bucket 0 counts latencies of less than 16 clock cycles. Each
+ * following bucket covers twice the range of the one before it, so bucket
+ * <tt>n</tt> counts latencies from <tt>8 << n</tt> up to <tt>16 << n</tt>
+ * cycles. The last bucket also counts everything longer.
+ */
+#  define JITTER_BUCKETS      12
+
+/**
+ * @brief Latency distribution for one interrupt, in system clock cycles.
+ */
+typedef struct
+{
+  uint32_t Count;
+  uint32_t Min;
+  uint32_t Max;
+  uint32_t Bucket[JITTER_BUCKETS];
+} JitterStats_t;
+
+extern volatile JitterStats_t Jitter[JITTER_NUM_SOURCES];
+
+//
+// Clear the statistics and start the cycle counter, call after all of the
+// interrupt sources have been initialized
+//
+void Jitter_Init(void);
+//
+// Called first thing in each measured interrupt handler
+//
+void Jitter_SysTick(void);
+void Jitter_ADC(void);
+void Jitter_I2C(uint32_t status);
+
+#endif
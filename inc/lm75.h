@@ -0,0 +1,137 @@
+/**
+ * @file lm75.h
+ *
+ * @brief User interface to the LM75 temperature sensor functions.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T14:05:22-0400
+ * @date Last modified: 2026-10-20T13:18:44-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _LM75_H_
+#  define _LM75_H_
+
+/**
+ * @def LM75B_MODE
+ * @brief Set to 1 if the sensor is an LM75B with 11-bit resolution.
+ * @details The original LM75 reports temperature in 0.5 C steps using the
+ * top 9 bits of its two-byte register. The LM75B uses the top 11 bits for
+ * 0.125 C steps. Either way the register is a two's complement value.
+ * It may be set on the compiler command line with <tt>-DLM75B_MODE=1</tt>.
+ */
+#  ifndef LM75B_MODE
+#    define LM75B_MODE  0
+#  endif
+
+/**
+ * @def TEMP_FRAC_BITS
+ * @brief Number of fractional bits in a temperature value.
+ * @details All temperatures are signed fixed-point values in units of
+ * 1/256 degree C, which is the weight of the LSB of the sensor register.
+ */
+#  define TEMP_FRAC_BITS  8
+
+/**
+ * @def TEMP_NONE
+ * @brief The temperature value that stands for no reading.
+ * @details It is below anything an LM75 can report, and it fits the 16-bit
+ * temperature registers of the register map and the telemetry record.
+ */
+#  define TEMP_NONE  INT16_MIN
+
+/**
+ * @name Sensor addresses
+ * @details An LM75 has three address pins, so up to ::LM75_MAX_SENSORS of
+ * them can share the bus at 8-bit addresses from ::LM75_BASE_ADDR upward.
+ * The sensor at ::LM75_BATTERY_ADDR is the one attached to the battery. If
+ * there is no sensor at that address then the first sensor found is used.
+ */
+/**@{*/
+#  define LM75_BASE_ADDR     0x90
+#  define LM75_MAX_SENSORS   8
+#  define LM75_BATTERY_ADDR  LM75_ADDR
+/**@}*/
+
+/**
+ * @def TEMP_READ_TICKS
+ * @brief Number of SysTicks between sensor reads.
+ * @details The sensors are read in turn, so each one is read once every
+ * ::TEMP_READ_TICKS times the number of sensors.
+ */
+#  define TEMP_READ_TICKS  (TICKS_PER_SEC / 10)
+
+/**
+ * @def TEMP_MISSED_READS
+ * @brief Number of reads a sensor may miss before it is taken to be lost.
+ * @details A lost sensor's last temperature is no longer used. If the
+ * battery sensor is lost the charger stops with ::FAULT_SENSOR.
+ */
+#  define TEMP_MISSED_READS  5
+
+/**
+ * @def TEMP_SAMPLES_TO_AVERAGE
+ * @brief Number of readings in the moving-average window of each sensor.
+ * @details The filtered temperature is the mean of the last
+ * ::TEMP_SAMPLES_TO_AVERAGE readings, so after a step it reaches the new
+ * value in exactly that many readings.
+ */
+#  define TEMP_SAMPLES_TO_AVERAGE  8
+
+/**
+ * @brief One entry in the registry of sensors found on the bus.
+ */
+typedef struct
+{
+  uint32_t Address;       ///< 8-bit I2C address
+  uint32_t Valid;         ///< Non-zero once a reading has been filtered
+  int32_t Temperature;    ///< Filtered temperature, written by SysTick
+  int32_t Samples[TEMP_SAMPLES_TO_AVERAGE]; ///< The readings in the window
+  uint32_t Next;          ///< Index in Samples of the oldest reading
+  int32_t FilterSum;      ///< Sum of the readings in Samples
+  uint32_t Errors;        ///< Number of failed reads
+  uint32_t LastReadTick;  ///< ::TickCount of the last good read
+  uint32_t Lost;          ///< Non-zero if the sensor has stopped answering
+} LM75Sensor_t;
+
+extern volatile LM75Sensor_t LM75Sensors[LM75_MAX_SENSORS];
+extern uint32_t LM75SensorCount;
+extern uint32_t LM75BatterySensor;
+
+//
+// Scan the bus for sensors, call after I2CInit() and SysTick_Config()
+//
+uint32_t LM75_Init(void);
+//
+// Start the next sensor read when one is due, call often from the main loop
+//
+void LM75_Poll(void);
+//
+// Convert the two register bytes to a temperature
+//
+int32_t LM75_Decode(uint8_t msb, uint8_t lsb);
+//
+// Add a new reading to a sensor's filter and return its filtered temperature
+//
+int32_t LM75_Filter(uint32_t sensor, int32_t reading);
+//
+// Mark sensors that have stopped answering as lost
+//
+void LM75_Expire(void);
+//
+// Find the highest filtered temperature of all sensors
+//
+int32_t LM75_Hottest(void);
+
+#endif
@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-12T15:34:58-0500
- * @date Last modified: 2014-01-12T16:08:26-0500
+ * @date Last modified: 2026-10-19T23:57:31-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -113,5 +113,9 @@ void PWM_IncreaseDutyCycle();
 // Decrease the PWM duty cycle
 //
 void PWM_DecreaseDutyCycle();
+//
+// Read the PWM duty cycle, in units of 1/65536
+//
+uint32_t PWM_Duty();
 
 #endif
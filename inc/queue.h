@@ -0,0 +1,81 @@
+/**
+ * @file queue.h
+ *
+ * @brief Lock-free single-producer, single-consumer event queue.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T10:41:05-0400
+ * @date Last modified: 2026-10-20T08:41:09-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _QUEUE_H_
+#  define _QUEUE_H_
+
+/**
+ * @def QUEUE_SIZE
+ * @brief Number of events each queue can hold, must be a power of 2.
+ */
+#  define QUEUE_SIZE     8
+
+#  if (QUEUE_SIZE & (QUEUE_SIZE - 1)) != 0
+#    error QUEUE_SIZE must be a power of 2
+#  endif
+
+/**
+ * @brief One event passed through a queue.
+ */
+typedef struct
+{
+  uint32_t Type;
+  int32_t Value;
+} Event_t;
+
+/**
+ * @brief A ring buffer of events.
+ * @details ::Head is written only by the producer and ::Tail only by the
+ * consumer. Both count up forever and are reduced modulo ::QUEUE_SIZE when
+ * the buffer is indexed, so the queue is full when they differ by
+ * ::QUEUE_SIZE and empty when they are equal. ::Dropped counts events that
+ * were discarded because the queue was full, and is written only by the
+ * producer.
+ */
+typedef struct
+{
+  volatile uint32_t Head;
+  volatile uint32_t Tail;
+  volatile uint32_t Dropped;
+  volatile Event_t Event[QUEUE_SIZE];
+} EventQueue_t;
+
+/**
+ * @var SensorEvents
+ * @brief Sensor readings from the I2C interrupt to the SysTick control loop.
+ */
+extern EventQueue_t SensorEvents;
+
+//
+// Empty a queue, call before either side starts using it
+//
+void Queue_Init(EventQueue_t *queue);
+//
+// Add an event, returns 0 and counts a dropped event if the queue is full
+//
+uint32_t Queue_Put(EventQueue_t *queue, uint32_t type, int32_t value);
+//
+// Remove the oldest event, returns 0 if the queue is empty
+//
+uint32_t Queue_Get(EventQueue_t *queue, Event_t *event);
+
+#endif
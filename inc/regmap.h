@@ -0,0 +1,72 @@
+/**
+ * @file regmap.h
+ *
+ * @brief User interface to the register map read by an external supervisor.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T16:14:37-0400
+ * @date Last modified: 2026-10-20T13:18:44-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _REGMAP_H_
+#  define _REGMAP_H_
+
+/**
+ * @def REGMAP_VERSION
+ * @brief Layout version, change this whenever ::RegMap_t changes.
+ */
+#  define REGMAP_VERSION  1
+
+/**
+ * @brief The registers, as seen by the supervisor.
+ * @details The supervisor writes one byte to select a register offset, and
+ * then reads from that offset onward. Multi-byte values are little-endian.
+ * Reading past the end of the map returns 0xFF. A temperature with no
+ * reading behind it is ::TEMP_NONE.
+ */
+typedef struct
+{
+  uint8_t Version;              ///< 0x00: ::REGMAP_VERSION
+  uint8_t State;                ///< 0x01: ::ChargerState
+  uint8_t Fault;                ///< 0x02: ::ChargerFault
+  uint8_t Sequence;             ///< 0x03: Incremented by every update
+  uint16_t Voltage_mV;          ///< 0x04: Battery voltage
+  uint16_t Current_mA;          ///< 0x06: Charging current
+  int16_t Temperature;          ///< 0x08: Battery temperature, 1/256 C
+  int16_t HottestTemperature;   ///< 0x0A: Hottest sensor, 1/256 C
+  uint32_t Charge_mAh;          ///< 0x0C: Charge delivered since reset
+} RegMap_t;
+
+#  define REGMAP_SIZE  sizeof(RegMap_t)
+
+//
+// Fill in the constant registers, call before the I2C slave is enabled
+//
+void RegMap_Init(void);
+//
+// Publish a new snapshot, called from the SysTick handler
+//
+void RegMap_Update(uint32_t voltage_mV, uint32_t current_mA,
+                   uint32_t charge_mAh);
+//
+// Hold the latest snapshot for a read, called from the I2C handler
+//
+const uint8_t *RegMap_Acquire(void);
+//
+// Let the snapshot being read be reused, called from the I2C handler
+//
+void RegMap_Release(void);
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file stack.h
+ *
+ * @brief User interface to the stack high-water-mark functions.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T11:20:48-0400
+ * @date Last modified: 2026-10-19T11:20:48-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _STACK_H_
+#  define _STACK_H_
+
+/**
+ * @def STACK_PAINT
+ * @brief The pattern written to every word of the stack at reset.
+ * @details This must agree with the value used by Reset_Handler in
+ * startup_lpc11.s.
+ */
+#  define STACK_PAINT  0xC5C5C5C5uL
+
+/**
+ * @var StackPeak
+ * @brief The stack high-water mark, in bytes, updated by the main loop.
+ */
+extern volatile uint32_t StackPeak;
+
+//
+// Size of the stack reserved by the linker, in bytes
+//
+uint32_t Stack_Size(void);
+//
+// Largest number of stack bytes ever used since reset
+//
+uint32_t Stack_HighWater(void);
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file telemetry.h
+ *
+ * @brief User interface to the telemetry records sent on the UART.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T23:57:31-0400
+ * @date Last modified: 2026-10-20T13:18:44-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _TELEMETRY_H_
+#  define _TELEMETRY_H_
+
+/**
+ * @def TELEMETRY_ENABLE
+ * @brief Set to 1 to send a ::Telemetry_t record on the UART every
+ * ::TELEMETRY_TICKS system ticks.
+ */
+#  ifndef TELEMETRY_ENABLE
+#    define TELEMETRY_ENABLE  0
+#  endif
+
+/**
+ * @def TELEMETRY_TICKS
+ * @brief Number of system ticks between records, 1 for every control period.
+ */
+#  ifndef TELEMETRY_TICKS
+#    define TELEMETRY_TICKS  1
+#  endif
+
+/**
+ * @name Record framing
+ */
+/**@{*/
+#  define TELEMETRY_SYNC0  0xA5     ///< First byte of every record
+#  define TELEMETRY_SYNC1  0x5A     ///< Second byte of every record
+/**@}*/
+
+/**
+ * @brief One telemetry record, as sent on the UART.
+ * @details Multi-byte values are little-endian. The bytes from Sequence
+ * through Checksum add up to 0, modulo 256.
+ */
+typedef struct
+{
+  uint8_t Sync0;                ///< 0x00: ::TELEMETRY_SYNC0
+  uint8_t Sync1;                ///< 0x01: ::TELEMETRY_SYNC1
+  uint8_t Sequence;             ///< 0x02: Incremented by every record
+  uint8_t State;                ///< 0x03: ::ChargerState
+  uint16_t Voltage_mV;          ///< 0x04: Battery voltage
+  uint16_t Current_mA;          ///< 0x06: Charging current
+  int16_t Temperature;          ///< 0x08: Battery temperature, 1/256 C,
+                                ///< or ::TEMP_NONE if there is no reading
+  uint16_t Duty;                ///< 0x0A: PWM duty cycle, 1/65536
+  uint16_t Dropped;             ///< 0x0C: Records lost, low 16 bits
+  uint8_t Fault;                ///< 0x0E: ::ChargerFault
+  uint8_t Checksum;             ///< 0x0F: Makes the byte sum 0
+} Telemetry_t;
+
+#  define TELEMETRY_SIZE  sizeof(Telemetry_t)
+
+//
+// Queue a record if one is due, called from the SysTick handler
+//
+void Telemetry_Update(uint32_t voltage_mV, uint32_t current_mA);
+
+#endif
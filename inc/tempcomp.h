@@ -0,0 +1,43 @@
+/**
+ * @file tempcomp.h
+ *
+ * @brief User interface to the temperature compensation of charging voltages.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T14:48:09-0400
+ * @date Last modified: 2026-10-19T16:57:03-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _TEMPCOMP_H_
+#  define _TEMPCOMP_H_
+
+//
+// Find the voltage offset for a temperature, in mV
+//
+int32_t TempComp_Offset(int32_t temperature);
+//
+// Apply an offset to a nominal setpoint and clamp the result
+//
+uint32_t TempComp_Setpoint(uint32_t nominal_mV, int32_t offset_mV);
+//
+// Record a temperature sample and predict where the temperature is going
+//
+int32_t TempComp_Predict(int32_t hottest);
+//
+// Reduce a charging current for the predicted hottest temperature
+//
+uint32_t TempComp_Derate(uint32_t nominal_mA, int32_t hottest);
+
+#endif
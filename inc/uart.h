@@ -0,0 +1,60 @@
+/**
+ * @file uart.h
+ *
+ * @brief User interface to the interrupt-driven UART transmitter.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T23:57:31-0400
+ * @date Last modified: 2026-10-19T23:57:31-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _UART_H_
+#  define _UART_H_
+
+/**
+ * @def UART_BAUD
+ * @brief The UART bit rate, 8 data bits, no parity, 1 stop bit.
+ */
+#  ifndef UART_BAUD
+#    define UART_BAUD  115200
+#  endif
+
+/**
+ * @def UART_TX_SIZE
+ * @brief Number of bytes the transmit buffer can hold, must be a power of 2.
+ */
+#  define UART_TX_SIZE  256
+
+#  if (UART_TX_SIZE & (UART_TX_SIZE - 1)) != 0
+#    error UART_TX_SIZE must be a power of 2
+#  endif
+
+/**
+ * @var UARTTxDropped
+ * @brief Number of writes discarded because the transmit buffer was full.
+ */
+extern volatile uint32_t UARTTxDropped;
+
+//
+// Set up the UART on PIO1_6 (RXD) and PIO1_7 (TXD) and enable its interrupt
+//
+void UART_Init(void);
+//
+// Queue bytes to send, returns 0 and counts a dropped write if they do not
+// all fit. Must only be called from one interrupt level.
+//
+uint32_t UART_Write(const uint8_t *data, uint32_t length);
+
+#endif
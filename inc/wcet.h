@@ -0,0 +1,81 @@
+/**
+ * @file wcet.h
+ *
+ * @brief User interface to the execution time measurement functions.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T11:58:31-0400
+ * @date Last modified: 2026-10-20T13:42:06-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _WCET_H_
+#  define _WCET_H_
+
+/**
+ * @def WCET_MEASUREMENT
+ * @brief Set to 1 to measure the execution time of each interrupt handler.
+ * @details The measurement code is only compiled in when this is non-zero.
+ * It may be set on the compiler command line with
+ * <tt>-DWCET_MEASUREMENT=1</tt>. Timer CT32B0 is used as a free-running
+ * cycle counter while this mode is enabled, and it may be shared with
+ * ::JITTER_MEASUREMENT. The same table, in host instructions and in
+ * estimated cycles, is printed by <tt>make -C test bench</tt>.
+ */
+#  ifndef WCET_MEASUREMENT
+#    define WCET_MEASUREMENT 0
+#  endif
+
+/**
+ * @name Measured paths
+ * @details Index values for the ::Wcet table. The SysTick handler has one
+ * path for each ::ChargerState, plus one for a tick in which a fault was
+ * detected. The I2C handler has one path for each status code from 0x00 to
+ * 0x58, in steps of 8, plus one for any other status code.
+ */
+/**@{*/
+#  define WCET_SYSTICK        0
+#  define WCET_SYSTICK_FAULT  (WCET_SYSTICK + TRICKLE + 1)
+#  define WCET_ADC            (WCET_SYSTICK_FAULT + 1)
+#  define WCET_I2C            (WCET_ADC + 1)
+#  define WCET_I2C_CODES      12
+#  define WCET_I2C_OTHER      (WCET_I2C + WCET_I2C_CODES)
+#  define WCET_NUM_PATHS      (WCET_I2C_OTHER + 1)
+/**@}*/
+
+/**
+ * @brief Execution time statistics for one path, in system clock cycles.
+ */
+typedef struct
+{
+  uint32_t Count;
+  uint32_t Max;
+} WcetPath_t;
+
+extern volatile WcetPath_t Wcet[WCET_NUM_PATHS];
+
+//
+// Clear the table and start the cycle counter
+//
+void WCET_Init(void);
+//
+// Read the cycle counter at the start of a handler
+//
+uint32_t WCET_Start(void);
+//
+// Record the time since WCET_Start() against a path
+//
+void WCET_Record(uint32_t path, uint32_t start);
+
+#endif
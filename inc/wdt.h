@@ -0,0 +1,96 @@
+/**
+ * @file wdt.h
+ *
+ * @brief User interface to the watchdog deadline monitor.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T09:12:40-0400
+ * @date Last modified: 2026-10-20T10:18:55-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _WDT_H_
+#  define _WDT_H_
+
+/**
+ * @name Watchdog timing
+ * @details The watchdog runs from the 12 MHz IRC so that its timing does not
+ * depend on the PLL setup. The watchdog counter is clocked at one quarter of
+ * its input clock. The watchdog resets the processor if it is not fed within
+ * ::WDT_TIMEOUT_MS, and a feed that comes less than ::WDT_WINDOW_MS after the
+ * previous one also causes a reset, which catches a SysTick handler that has
+ * started running away.
+ */
+/**@{*/
+#  define WDT_CLK_FREQ      12000000
+#  define WDT_TIMEOUT_MS    100
+#  define WDT_WINDOW_MS     5
+/**@}*/
+
+/**
+ * @name Supervised tasks
+ * @details Each supervised task must call WDT_CheckIn() with its own task
+ * number at least once every deadline period. The deadlines are given in
+ * SysTick periods.
+ *   - The control task is the state machine in SysTick_Handler().
+ *   - The ADC task is ADC_IRQHandler(), which runs many times per SysTick.
+ *   - The UI task is the LCD writer, LCD_Poll(), which checks in whenever
+ *     the LCD is ready for more.
+ *   - The main task is the foreground loop that starts the temperature sensor
+ *     reads and writes changes to the LCD.
+ *
+ * The UI and main tasks both run in the foreground, which is held up at
+ * startup by the sensor scan and, with an I2C backpack, the LCD setup, so
+ * they have the same long deadline.
+ */
+/**@{*/
+#  define WDT_TASK_CONTROL  0
+#  define WDT_TASK_ADC      1
+#  define WDT_TASK_UI       2
+#  define WDT_TASK_MAIN     3
+#  define WDT_NUM_TASKS     4
+#  define WDT_TASK_NONE     0xFF
+
+#  define WDT_DEADLINE_CONTROL  2
+#  define WDT_DEADLINE_ADC      2
+#  define WDT_DEADLINE_UI       50
+#  define WDT_DEADLINE_MAIN     50
+/**@}*/
+
+//
+// Start the watchdog, should be called just once after the SysTick is running
+//
+void WDT_Init(void);
+//
+// Record that a supervised task has run
+//
+void WDT_CheckIn(uint32_t task);
+//
+// Check all deadlines and feed the watchdog, called once per SysTick
+//
+void WDT_Service(void);
+//
+// The task that missed its deadline before the last watchdog reset
+//
+uint32_t WDT_LastFailure(void);
+//
+// A 16 character message naming the failed task
+//
+const char *WDT_FailureMessage(uint32_t task);
+//
+// Watchdog warning interrupt, just before the reset
+//
+void WDT_IRQHandler(void);
+
+#endif
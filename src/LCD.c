@@ -0,0 +1,266 @@
+/**
+ * @file LCD.c
+ *
+ * @brief Functions for displaying text, shared by the LCD interfaces.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T23:18:40-0400
+ * @date Last modified: 2026-10-20T11:48:12-0400
+ *
+ * @details The HD44780 command set and the text handling are the same
+ * whichever way the LCD is wired. The wiring is handled by one of two back
+ * ends: LCD4.c drives a 4-bit parallel interface from GPIO pins, and
+ * LCD8574.c drives a PCF8574 I2C backpack. ::LCD_I2C_BACKPACK selects one.
+ *
+ * @copyright Copyright (C) 2014 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "LCD.h"
+#include "wdt.h"
+
+/**
+ * @var   DisplayLines
+ * @brief The character strings to be written to the LCD, indexed by row.
+ * @details This is a draft. The LCD only shows a copy of it made by
+ * LCD_Publish(), so it may be changed piece by piece at any time.
+ * @var   Shown
+ * @brief The characters that are currently on the LCD, indexed by row.
+ */
+char DisplayLines[MAX_ROW+1][MAX_COL+1];
+static char Shown[MAX_ROW+1][MAX_COL+1];
+
+//
+// Number of published frames, see LCD_Publish()
+//
+#define NUM_FRAMES  3
+
+/**
+ * @var   Frame
+ * @brief Published copies of ::DisplayLines.
+ * @var   Published
+ * @brief Index of the newest published frame.
+ * @var   Showing
+ * @brief Index of the frame that is being written to the LCD.
+ */
+static char Frame[NUM_FRAMES][MAX_ROW+1][MAX_COL+1];
+static volatile uint32_t Published;
+static volatile uint32_t Showing;
+
+/**
+ * @var   Row
+ * @brief The row number where the next character is written on the LCD.
+ * @var   Col
+ * @brief The column number where the next character is written on the LCD.
+ * @details When Col is greater than ::MAX_COL the LCD's address is past the
+ *   visible part of the row, and a command must be sent to move it.
+ */
+static uint32_t Row;
+static uint32_t Col;
+
+//
+// LCD commands to set the character generator and display addresses, and the
+// address of each row. A 4-row display is driven as two long rows, so rows 2
+// and 3 carry on from the ends of rows 0 and 1.
+//
+static const uint8_t LCD_SET_CGRAM = 0x40;
+static const uint8_t LCD_SET_DDRAM = 0x80;
+static const uint8_t LCD_ROW_ADDR[MAX_ROW+1] = {
+  0x00, 0x40,
+#if LCD_ROWS == 4
+  0x00 + LCD_COLS, 0x40 + LCD_COLS
+#endif
+};
+
+/**
+ * @var BarGlyphs
+ * @brief Pixel rows of the custom characters for partly lit bar graph cells.
+ * @details These are loaded into CGRAM starting at character code 1, so that
+ * code 0 is never used and the display strings can still be handled as C
+ * strings. The bottom row is left blank, like the built-in 5x7 characters.
+ * @var BarCell
+ * @brief The character for a bar graph cell with 0 to ::LCD_BAR_STEPS steps
+ * lit. A fully lit cell uses the LCD's built-in solid block, 0xFF.
+ */
+static const uint8_t BarGlyphs[LCD_BAR_STEPS - 1][8] = {
+  {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00},
+  {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00},
+  {0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x00},
+  {0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x00}
+};
+static const char BarCell[LCD_BAR_STEPS + 1] = {' ', 1, 2, 3, 4, (char) 0xFF};
+
+/**
+ * @brief Writes the next changed character to the LCD.
+ * 
+ * @details The characters in the frame being shown, ::Showing, are compared
+ * with ::Shown, the copy of what is on the LCD. The search starts at the
+ * LCD's current address, given by the local variables Row and Col, so that a
+ * run of changed characters is written without moving the address. If the
+ * first changed character is somewhere else, a command that moves the
+ * address there is written instead, and the character itself is written on
+ * the next call. When the whole frame is on the LCD, the newest published
+ * frame becomes the one shown, so the LCD never mixes the text of two frames
+ * for longer than it takes to write one.
+ * 
+ * @warning
+ * This function does not check the BUSY flag from the LCD. There must be a
+ * time greater than the longest LCD command execution time between calls of
+ * this function.
+ */
+void LCD_WriteNextChar()
+{
+  char (*frame)[MAX_COL+1] = Frame[Showing];
+  uint32_t row = Row;
+  uint32_t col = Col;
+  uint32_t n;
+
+  for (n = 0; n < (MAX_ROW + 1) * (MAX_COL + 1); n++) {
+    if (col > MAX_COL) {
+      col = 0;
+      if (++row > MAX_ROW)
+        row = 0;
+    }
+    if (frame[row][col] != Shown[row][col])
+      break;
+    col++;
+  }
+  if (n == (MAX_ROW + 1) * (MAX_COL + 1)) {
+    Showing = Published;
+    return;
+  }
+  if ((row != Row) || (col != Col)) {
+    LCD_WriteCommandNoWait(LCD_SET_DDRAM | (LCD_ROW_ADDR[row] + col));
+    Row = row;
+    Col = col;
+  } else {
+    Shown[row][col] = frame[row][col];
+    LCD_WriteDataNoWait(Shown[row][col]);
+    Col++;
+  }
+}
+/**
+ * @brief Makes the text now in ::DisplayLines the next frame for the LCD.
+ * @details This must only be called from the SysTick handler, after it has
+ * finished changing ::DisplayLines. It works like the register map snapshots:
+ * of three frames, one is the newest, one may be being written to the LCD by
+ * LCD_WriteNextChar(), and the copy always goes into the third. The SysTick
+ * handler can interrupt the main loop but not the other way around, so it
+ * never waits, and a frame is never changed while it is being shown.
+ */
+void LCD_Publish(void)
+{
+  uint32_t next;
+  uint32_t row, col;
+
+  for (next = 0; (next == Published) || (next == Showing); next++) {
+  }
+  for (row = 0; row <= MAX_ROW; row++)
+    for (col = 0; col <= MAX_COL; col++)
+      Frame[next][row][col] = DisplayLines[row][col];
+  __DMB();
+  Published = next;
+}
+/**
+ * @brief Draws a horizontal bar graph into a display string.
+ * @details Each cell is looked up in ::BarCell, so the cost is a compare and
+ * a subtract per cell whatever the value.
+ *
+ * @param[out] dest the first character of the bar in ::DisplayLines
+ * @param[in] cells the length of the bar, in characters
+ * @param[in] fill the number of steps lit, from 0 to cells * ::LCD_BAR_STEPS
+ */
+void LCD_Bar(char *dest, uint32_t cells, uint32_t fill)
+{
+  uint32_t i;
+
+  for (i = 0; i < cells; i++) {
+    if (fill >= LCD_BAR_STEPS) {
+      dest[i] = BarCell[LCD_BAR_STEPS];
+      fill -= LCD_BAR_STEPS;
+    } else {
+      dest[i] = BarCell[fill];
+      fill = 0;
+    }
+  }
+}
+/**
+ * @brief Writes changed characters to the LCD as fast as it can take them.
+ * @details Each call writes at most one character or address command, and
+ * only if the LCD has finished the last one, so it never waits. Called
+ * continuously from the main loop, this sends a whole screen of changes at
+ * the speed of the LCD interface rather than one character per SysTick.
+ * Interrupts are never disabled; a SysTick may publish a new frame at any
+ * point, and it is simply found on a later call.
+ *
+ * This is the UI task for the watchdog. It checks in each time the LCD is
+ * ready for more, so an LCD that stays busy is the task named after a reset.
+ */
+void LCD_Poll(void)
+{
+  if (!LCD_Busy()) {
+    WDT_CheckIn(WDT_TASK_UI);
+    LCD_WriteNextChar();
+  }
+}
+/**
+ * @brief Initialize the LCD display.
+ * @details The back end first wakes the LCD and puts it in 4-bit mode, see
+ * LCD_InitInterface(). Then a sequence of commands is issued to:
+ *   - Configure the LCD for two rows of characters, each with 5x7 pixels (a
+ *     4-row display uses the same setting)
+ *   - Load the custom characters used for bar graphs into CGRAM
+ *   - Clear the display and move the cursor to the first character position
+ *   - Set the entry mode to automatically increment the character position
+ *     after each character is written to the display
+ *   - Turn on the display and make the cursor visible
+ */
+void LCD_Init(void)
+{
+  LCD_InitInterface();
+
+  LCD_WriteCommandNoWait(0x28); // 4-bit interface, 2 row, 5x7 char
+  Wait_LCD();
+  // Load the bar graph characters into CGRAM, starting at code 1
+  LCD_WriteCommandNoWait(LCD_SET_CGRAM | 8);
+  while (LCD_Busy());
+  for (Row = 0; Row < LCD_BAR_STEPS - 1; Row++) {
+    for (Col = 0; Col < 8; Col++) {
+      LCD_WriteDataNoWait(BarGlyphs[Row][Col]);
+      while (LCD_Busy());
+    }
+  }
+  LCD_WriteCommandNoWait(0x01); // clear display, cursor home
+  Wait_LCD();
+  LCD_WriteCommandNoWait(0x06); // Entry mode: Increment, Shift off
+  Wait_LCD();
+  LCD_WriteCommandNoWait(0x0F); // display on, cursor on
+  Wait_LCD();
+  //
+  // The clear command filled the LCD with spaces, and left its address at
+  // the first character. Start with blank display strings too, so rows that
+  // are not written yet stay blank.
+  //
+  for (Row = 0; Row <= MAX_ROW; Row++) {
+    for (Col = 0; Col <= MAX_COL; Col++) {
+      Shown[Row][Col] = ' ';
+      DisplayLines[Row][Col] = ' ';
+      Frame[0][Row][Col] = ' ';
+    }
+  }
+  Published = 0;
+  Showing = 0;
+  Row = 0;
+  Col = 0;
+}
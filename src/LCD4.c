@@ -1,11 +1,11 @@
 /**
  * @file LCD4.c
  *
- * @brief Functions for configuring the LCD and displaying text.
+ * @brief Drives the LCD through a 4-bit parallel interface on GPIO pins.
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-08T19:21:54-0500
- * @date Last modified: 2014-01-12T17:44:30-0500
+ * @date Last modified: 2026-10-20T11:48:12-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -24,23 +24,7 @@
 #include "charger.h"
 #include "LCD.h"
 
-/**
- * @var   TopLine
- * @brief Character string that is written to row 0 of the LCD display.
- * @var   BottomLine
- * @brief Character string that is written to row 1 of the LCD display.
- */
-char TopLine[MAX_COL+1];
-char BottomLine[MAX_COL+1];
-
-/**
- * @var   Row
- * @brief The row number where the next character is written on the LCD.
- * @var   Col
- * @brief The column number where the next character is written on the LCD.
- */
-static uint32_t Row;
-static uint32_t Col;
+#if !LCD_I2C_BACKPACK
 
 /**
  * @def LCD_DATA_Msk
@@ -77,76 +61,126 @@ static const uint32_t LCD_EN       = 1 << (LCD_CTRL_Pos + 2);
 static const uint32_t LCD_CTRL_Msk = 0x7 << LCD_CTRL_Pos ;
 
 /**
- * @def DELAY_RS_EN
- * @brief The LCD's required RS/RW-to-EN-asserted setup time (clock cycles).
- * @def DELAY_DA_EN
- * @brief The LCD's required Data-to-EN-deasserted setup time (clock cycles).
- * @def DELAY_EN_DA
- * @brief The LCD's maximum EN-asserted-to-Data-valid delay (clock cycles).
- * @def DELAY_EN_HIGH
- * @brief The LCD's required minimum EN high time (clock cycles).
- * @def DELAY_EN_HIGH
- * @brief The LCD's required minimum EN low time (clock cycles).
+ * @var DelayRsEn
+ * @brief The RS/RW-to-EN-asserted setup time, ::LCD_TAS, in delay() loops.
+ * @var DelayEnHigh
+ * @brief The minimum EN high time, ::LCD_TEH, in delay() loops.
+ * @var DelayEnLow
+ * @brief The minimum EN low time, ::LCD_TEL, in delay() loops.
+ * @details These are set by LCD_InitInterface() from SystemCoreClock,
+ * rounded up so that no delay is ever shorter than the LCD requires.
  */
-static const uint32_t DELAY_RS_EN    = LCD_TAS/CLKPER;
-static const uint32_t DELAY_DA_EN    = LCD_TDS/CLKPER;
-static const uint32_t DELAY_EN_DA    = LCD_TDA/CLKPER;
-static const uint32_t DELAY_EN_HIGH  = LCD_TEH/CLKPER;
-static const uint32_t DELAY_EN_LOW   = LCD_TEL/CLKPER;
+static uint32_t DelayRsEn;
+static uint32_t DelayEnHigh;
+static uint32_t DelayEnLow;
+
+//
+// Clock cycles taken by each pass through the delay() loop
+//
+static const uint32_t DELAY_LOOP_CYCLES = 4;
 
 /**
   @private
-  @brief A crude delay time for short delays.
-  @details Execute the processor's NOP instruction in a tight loop.
+  @brief Convert an LCD timing parameter to delay() loops.
 
-  @param[in] count number of loop executions
+  @param[in] ns the time in nanoseconds
+  @return the number of loops, at least 1
  */
-void delay(int count)
+static uint32_t DelayLoops(uint32_t ns)
 {
-  for (int i = 0; i < count; i++)
-    __NOP();
+  uint32_t mhz = (SystemCoreClock + 999999) / 1000000;
+  uint32_t cycles = (ns * mhz + 999) / 1000;
+  uint32_t loops = (cycles + DELAY_LOOP_CYCLES - 1) / DELAY_LOOP_CYCLES;
+
+  return loops ? loops : 1;
+}
+
+/**
+  @private
+  @brief A delay of an exact number of clock cycles.
+  @details On the Cortex-M0 each pass through this loop takes
+  ::DELAY_LOOP_CYCLES clocks, one for the subtract and three for the taken
+  branch, so the delay does not depend on how the compiler treats a C loop.
+  Off target only the number of loops matters, so a C loop is used there,
+  or ::LCD_DELAY_HOOK if it is defined.
+
+  @param[in] loops number of loop executions, must be at least 1
+ */
+static inline void delay(uint32_t loops)
+{
+#if defined(__arm__)
+  __ASM volatile ("1: subs %0, #1\n\tbne 1b" : "+l" (loops) : : "cc");
+#elif defined(LCD_DELAY_HOOK)
+  LCD_DELAY_HOOK(loops);
+#else
+  while (--loops)
+    __ASM volatile ("");
+#endif
 }
 /**
- * @private
  * @brief Busy-wait until the LCD display is not busy.
- * @details The busy flag from the LCD is on the same pin as the MSB of the
- * data, so first we change the direction of that GPIO bit to an input.
- * We set the Read/Write control to the read mode, wait a bit, then enable
- * the LCD.
- *
- * A tight loop reads the data from the LCD until the busy flag goes low.
- *
- * Finally, the LCD is disabled and then the Read/Write control is set to
- * the write mode. The direction of the busy flag is changed back to an
- * input. Since we have just deasserted the LCD enable signal we wait a bit
- * to make sure we satisfy the low time requirement for this signal.
- *
+ * @details The busy flag is read with LCD_Busy() until it goes low, so every
+ * read takes the two enable pulses that keep a 4-bit interface in step.
  */
 void Wait_LCD(void)
 {
-  //
-  // Make the BUSY flag an input, set control bits for READ, ENABLE
-  //
-  LCD_DATA_PORT->DIR &= ~LCD_BUSY_FLAG;
+  while (LCD_Busy());
+}
+/**
+ * @brief Read the busy flag without waiting for it.
+ * @details A read in 4-bit mode takes two enable pulses, the first for the
+ * high nibble with the busy flag and the second for the low nibble, which is
+ * discarded. A single pulse would leave the LCD waiting for the low nibble,
+ * and the next write would be taken out of step. Before the LCD is put in
+ * 4-bit mode each pulse is a whole read, so the second one simply reads the
+ * flag again and this is safe at any time. All four data pins are inputs
+ * while the LCD drives them.
+ *
+ * @return non-zero if the LCD is still busy with the last command or data
+ */
+uint32_t LCD_Busy(void)
+{
+  uint32_t busy;
+
+  LCD_DATA_PORT->DIR &= ~LCD_DATA_Msk;
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RW;
-  delay(DELAY_RS_EN);
+  delay(DelayRsEn);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RW | LCD_EN;
-  delay(DELAY_EN_DA);
-  //
-  // Wait for BUSY to be deasserted
-  //
-  while (LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] & LCD_BUSY_FLAG);
-  //
-  // Disable control bits, change BUSY back to an output
-  //
+  delay(DelayEnHigh);
+  busy = LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] & LCD_BUSY_FLAG;
+  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RW;
+  delay(DelayEnLow);
+  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RW | LCD_EN;
+  delay(DelayEnHigh);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RW;
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
   LCD_DATA_PORT->DIR |= LCD_DATA_Msk;
+  delay(DelayEnLow);
 
-  delay(DELAY_EN_LOW);
+  return busy;
 }
 /**
  * @private
+ * @brief Writes one nibble to the LCD.
+ * @details The data and the RS/RW controls are set up together, before EN
+ * rises, so a single wait of ::LCD_TAS covers the control setup and the
+ * EN high time of ::LCD_TEH covers the data setup. EN is then held low for
+ * ::LCD_TEL before anything else may be written.
+ *
+ * @param[in] ctrl ::LCD_RS for data, or 0 for a command
+ * @param[in] nibble the value for the data pins, in the low 4 bits
+ */
+static void WriteNibble(uint32_t ctrl, uint32_t nibble)
+{
+  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = ctrl;
+  LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = nibble << LCD_DATA_Pos;
+  delay(DelayRsEn);
+  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = ctrl | LCD_EN;
+  delay(DelayEnHigh);
+  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = ctrl;
+  delay(DelayEnLow);
+}
+/**
  * @brief Writes a command byte to the LCD using the 4-bit interface.
  *
  * @note Access to the GPIO data registers uses the "masked access" capability
@@ -157,24 +191,10 @@ void Wait_LCD(void)
  */
 void LCD_WriteCommandNoWait(uint8_t command)
 {
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_RS_EN);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_EN;
-  delay(DELAY_EN_DA);
-  LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = (command >> 4) << LCD_DATA_Pos;
-  delay(DELAY_DA_EN);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
-
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_EN;
-  delay(DELAY_EN_DA);
-  LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = command << LCD_DATA_Pos;
-  delay(DELAY_DA_EN);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
+  WriteNibble(0, command >> 4);
+  WriteNibble(0, command);
 }
 /**
- * @private
  * @brief Writes a data (character) byte to the LCD using the 4-bit interface.
  *
  * @note Access to the GPIO data registers uses the "masked access" capability
@@ -185,58 +205,15 @@ void LCD_WriteCommandNoWait(uint8_t command)
  */
 void LCD_WriteDataNoWait(uint8_t data)
 {
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RS;
-  delay(DELAY_RS_EN);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RS | LCD_EN;
-  delay(DELAY_EN_DA);
-  LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = (data >> 4) << LCD_DATA_Pos;
-  delay(DELAY_DA_EN);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RS;
-  delay(DELAY_EN_LOW);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RS | LCD_EN;
-  delay(DELAY_EN_DA);
-  LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = data << LCD_DATA_Pos;
-  delay(DELAY_DA_EN);
-  LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_RS;
+  WriteNibble(LCD_RS, data >> 4);
+  WriteNibble(LCD_RS, data);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
-}
-/**
- * @brief Writes the next character to the LCD.
- * 
- * @details The characters in the two display strings, ::TopLine and ::BottomLine, are
- * written to the LCD. One character is written each time this function is
- * called, except when changing from one row to the other when a command byte
- * is written instead. The local variables Row and Col are used to keep
- * track of the next location that should be written to.
- * 
- * @warning
- * This function does not check the BUSY flag from the LCD. There must be a
- * time greater than the longest LCD command execution time between calls of
- * this function.
- */
-void LCD_WriteNextChar()
-{
-  if (Col > MAX_COL) {
-    Col = 0;
-    if ((0 == Row) && (1 == MAX_ROW)) {
-      Row = 1;
-      LCD_WriteCommandNoWait(0xC0);
-    } else {
-      Row = 0;
-      LCD_WriteCommandNoWait(0x80);
-    }
-  } else {
-    if (0 == Row)
-      LCD_WriteDataNoWait(TopLine[Col]);
-    else
-      LCD_WriteDataNoWait(BottomLine[Col]);
-    Col++;
-  }
 }
 /**
- * @brief Initialize the LCD display.
- * @details Begin by changing the direction of the GPIO lines that connect to
+ * @brief Wake the LCD and put it in 4-bit mode.
+ * @details The delays used for the LCD timing are found first, from
+ * SystemCoreClock, so this must be called after the clock is set up. Then
+ * begin by changing the direction of the GPIO lines that connect to
  * the LCD control/data pins to outputs.
  *
  * The LCD wakes up in 8-bit data mode but we will eventually configure it for
@@ -252,62 +229,49 @@ void LCD_WriteNextChar()
  * After reset the LCD is configured for a 4-bit interface, but the command
  * that does this (<tt>0x20</tt>) is still an 8-bit command.
  *
- * Once the LCD is in 4-bit mode we can start using commands that have non-zero
- * values for the lower 4 bits. This is accomplished by first writing the upper
- * nibble of the command and then writing the lower nibble of the command. A
- * sequence of commands is issued to:
- *   - Configure the LCD for two rows of characters, each with 5x7 pixels
- *   - Clear the display and move the cursor to the first character position
- *   - Set the entry mode to automatically increment the character position
- *     after each character is written to the display
- *   - Turn on the display and make the cursor visible
- *
  * @note Access to the GPIO data registers uses the "masked access" capability
  * of the LPC GPIO ports, so there is no need to explicitly mask bits when
  * writing to the ports.
  */
-void LCD_Init(void)
+void LCD_InitInterface(void)
 {
+  // Convert the LCD timing to delays at the current clock frequency
+  DelayRsEn = DelayLoops(LCD_TAS);
+  DelayEnHigh = DelayLoops(LCD_TEH);
+  DelayEnLow = DelayLoops(LCD_TEL);
   // Set pins to outputs
   LCD_CTRL_PORT->DIR |= (LCD_EN | LCD_RS | LCD_RW);
   LCD_DATA_PORT->DIR |= LCD_DATA_Msk;
   // Send reset command to LCD in 8-bit mode
   LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = 0x3 << LCD_DATA_Pos;
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_RS_EN);
+  delay(DelayRsEn);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_EN;
-  delay(DELAY_EN_HIGH);
+  delay(DelayEnHigh);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
+  delay(DelayEnLow);
   Wait_LCD();
   // Send reset command to LCD in 8-bit mode (second time)
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_EN;
-  delay(DELAY_EN_HIGH);
+  delay(DelayEnHigh);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
+  delay(DelayEnLow);
   Wait_LCD();
   // Send reset command to LCD in 8-bit mode (third time)
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_EN;
-  delay(DELAY_EN_HIGH);
+  delay(DelayEnHigh);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
+  delay(DelayEnLow);
   Wait_LCD();
 
   // Send command to change LCD to 4-bit interface
   LCD_DATA_PORT->MASKED_ACCESS[LCD_DATA_Msk] = 0x2 << LCD_DATA_Pos;
-  delay(DELAY_RS_EN);
+  delay(DelayRsEn);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = LCD_EN;
-  delay(DELAY_EN_HIGH);
+  delay(DelayEnHigh);
   LCD_CTRL_PORT->MASKED_ACCESS[LCD_CTRL_Msk] = 0;
-  delay(DELAY_EN_LOW);
-  Wait_LCD();
-
-  LCD_WriteCommandNoWait(0x28); // 4-bit interface, 2 row, 5x7 char
-  Wait_LCD();
-  LCD_WriteCommandNoWait(0x01); // clear display, cursor home
-  Wait_LCD();
-  LCD_WriteCommandNoWait(0x06); // Entry mode: Increment, Shift off
-  Wait_LCD();
-  LCD_WriteCommandNoWait(0x0F); // display on, cursor on
+  delay(DelayEnLow);
   Wait_LCD();
 }
+
+#endif
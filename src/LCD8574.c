@@ -0,0 +1,184 @@
+/**
+ * @file LCD8574.c
+ *
+ * @brief Drives the LCD through a PCF8574 I2C backpack.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T23:18:40-0400
+ * @date Last modified: 2026-10-19T23:18:40-0400
+ *
+ * @details The PCF8574 is an 8-bit port expander that is wired to the LCD's
+ * control pins and upper four data pins. Every change on those pins is one
+ * byte written over I2C, so each character or command is a single
+ * transaction of ::LCD_WRITE_LENGTH bytes, queued with I2CSubmit() like the
+ * temperature sensor reads. The CPU only builds the bytes; the I2C interrupt
+ * does the rest. At 100 kHz one byte takes 90 us, much longer than any LCD
+ * setup or hold time, and the LCD has finished each character long before
+ * the next transaction can pulse EN, so the busy flag is never read.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "SysTick.h"
+#include "i2c.h"
+#include "wdt.h"
+#include "LCD.h"
+
+#if LCD_I2C_BACKPACK
+
+#if I2C_SPEED_HZ > 100000
+#error "The PCF8574 is rated for 100 kHz, set I2C_SPEED_HZ to 100000"
+#endif
+
+//
+// Bytes in a character or command: set RS, then EN high and low for each
+// nibble
+//
+#define LCD_WRITE_LENGTH  5
+
+#if LCD_WRITE_LENGTH > BUFSIZE
+#error "BUFSIZE is too small for an LCD write"
+#endif
+
+//
+// SysTicks to wait after a command that may be slow. Waiting for two ticks
+// to start gives at least one whole tick, 10 ms, much longer than the 4.1 ms
+// needed after the first reset command or the 1.52 ms needed to clear.
+//
+static const uint32_t LCD_SLOW_TICKS = 2;
+
+/**
+ * @var LCDWrite
+ * @brief The I2C transaction that writes to the backpack.
+ */
+static I2CTransaction LCDWrite;
+
+/**
+ * @private
+ * @brief Wait for a number of SysTicks to start.
+ *
+ * @param[in] ticks the number of ticks
+ */
+static void WaitTicks(uint32_t ticks)
+{
+  uint32_t start = TickCount;
+
+  while ((TickCount - start) < ticks)
+    WDT_CheckIn(WDT_TASK_MAIN);
+}
+/**
+ * @private
+ * @brief Queue a write of the bytes in ::LCDWrite.
+ * @details The previous write must have finished. The queue has room for
+ * this transaction and the sensor read, so I2CSubmit() cannot fail here.
+ *
+ * @param[in] length the number of bytes
+ */
+static void SubmitWrite(uint32_t length)
+{
+  LCDWrite.WriteLength = length;
+  I2CSubmit(&LCDWrite);
+}
+/**
+ * @private
+ * @brief Writes a byte to the LCD as two nibbles.
+ *
+ * @param[in] rs ::LCD_PCF_RS for data, or 0 for a command
+ * @param[in] byte the command or data byte
+ */
+static void WriteByte(uint32_t rs, uint8_t byte)
+{
+  uint8_t ctrl = rs | LCD_PCF_BL;
+  uint8_t hi = ((byte >> 4) << LCD_PCF_DATA_Pos) | ctrl;
+  uint8_t lo = ((byte & 0xF) << LCD_PCF_DATA_Pos) | ctrl;
+
+  LCDWrite.WriteData[0] = hi;
+  LCDWrite.WriteData[1] = hi | LCD_PCF_EN;
+  LCDWrite.WriteData[2] = hi;
+  LCDWrite.WriteData[3] = lo | LCD_PCF_EN;
+  LCDWrite.WriteData[4] = lo;
+  SubmitWrite(LCD_WRITE_LENGTH);
+}
+/**
+ * @brief Wait until the LCD is ready for the next command.
+ * @details The busy flag is not read, so this waits for the write to finish
+ * and then for longer than the slowest command takes. It is only meant for
+ * initialization.
+ */
+void Wait_LCD(void)
+{
+  while (I2C_BUSY == LCDWrite.Status) {
+    WDT_CheckIn(WDT_TASK_MAIN);
+    I2CCheckTimeout();
+  }
+  WaitTicks(LCD_SLOW_TICKS);
+}
+/**
+ * @brief Find out whether the last write is still in progress.
+ * @details The LCD itself is ready as soon as the write has finished, see
+ * the file description. A write that has timed out is finished here, so
+ * that waiting on this cannot hang if the bus is stuck.
+ *
+ * @return non-zero if the last command or character has not been sent yet
+ */
+uint32_t LCD_Busy(void)
+{
+  I2CCheckTimeout();
+  return I2C_BUSY == LCDWrite.Status;
+}
+/**
+ * @brief Writes a command byte to the LCD through the backpack.
+ *
+ * @param[in] command the command byte
+ */
+void LCD_WriteCommandNoWait(uint8_t command)
+{
+  WriteByte(0, command);
+}
+/**
+ * @brief Writes a data (character) byte to the LCD through the backpack.
+ *
+ * @param[in] data the ASCII character to display
+ */
+void LCD_WriteDataNoWait(uint8_t data)
+{
+  WriteByte(LCD_PCF_RS, data);
+}
+/**
+ * @brief Wake the LCD and put it in 4-bit mode.
+ * @details This needs the I2C master and the SysTick to be running. The
+ * reset command (<tt>0x30</tt>) is sent to the LCD three times and then the
+ * command for a 4-bit interface (<tt>0x20</tt>), each as a single nibble
+ * since the LCD may still be in 8-bit mode.
+ */
+void LCD_InitInterface(void)
+{
+  static const uint8_t reset[4] = {0x3, 0x3, 0x3, 0x2};
+  uint32_t i;
+  uint8_t nibble;
+
+  LCDWrite.Address = LCD_I2C_ADDR;
+  LCDWrite.ReadLength = 0;
+  LCDWrite.Callback = 0;
+  for (i = 0; i < 4; i++) {
+    nibble = (reset[i] << LCD_PCF_DATA_Pos) | LCD_PCF_BL;
+    LCDWrite.WriteData[0] = nibble;
+    LCDWrite.WriteData[1] = nibble | LCD_PCF_EN;
+    LCDWrite.WriteData[2] = nibble;
+    SubmitWrite(3);
+    Wait_LCD();
+  }
+}
+
+#endif
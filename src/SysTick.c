@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-08T19:47:51-0500
- * @date Last modified: 2014-01-12T17:45:35-0500
+ * @date Last modified: 2026-10-20T15:02:40-0400
  *
  * @details The PWM duty cycle is changed as necessary and the LCD display is
  * updated when this interrupt is serviced.
@@ -29,19 +29,85 @@
 #include "LCD.h"
 #include "pwm.h"
 #include "adc.h"
+#include "wdt.h"
+#include "jitter.h"
+#include "queue.h"
+#include "wcet.h"
+#include "lm75.h"
+#include "tempcomp.h"
+#include "i2c.h"
+#include "regmap.h"
+#include "format.h"
+#include "telemetry.h"
 
 /**
  * @var   Ticks
  * @brief Counts SysTick interrupts to support long interval timing.
  */
-uint32_t Ticks;
+volatile uint32_t Ticks;
+
+/**
+ * @var   TickCount
+ * @brief Counts every SysTick interrupt since reset, it is never cleared.
+ * @details This is the time base for timeouts. Differences between two values
+ * are correct even after the counter wraps around.
+ */
+volatile uint32_t TickCount;
+
+/**
+ * @brief Where a measurement is shown on the display.
+ */
+typedef struct
+{
+  uint8_t Row;                  ///< Display row
+  uint8_t Col;                  ///< First column of the field
+  uint8_t Width;                ///< Characters in the field, 0 if not shown
+} DisplayField_t;
+
+//
+// The measurements that can be shown, indexing the Layout table
+//
+enum DisplayFieldIndex {
+  FIELD_VOLTAGE,
+  FIELD_CURRENT,
+  FIELD_TEMPERATURE,
+  FIELD_CHARGE,
+  FIELD_TIME,
+  NUM_FIELDS
+};
 
 //
-// This is the basic text used for the second row of the display when the
-// charger is running. The actual digits are inserted by the
-// DisplayMeasurements function.
+// This is the basic text used for the rows below the top row when the
+// charger is running, and the position of each measurement in it. The actual
+// digits are inserted by the DisplayMeasurements function. The top row is
+// always the charging stage and progress bar. The charging time is shown as
+// hours, minutes and seconds, so its field must be 8 characters wide.
 //
-static const char *StatusLine = "00.0V 0.0A  00 C";
+#if LCD_ROWS == 4
+static const char * const StatusLines[MAX_ROW] = {
+  "     V      A     \337C",
+  "Charge            Ah",
+  "Time          :  :  "
+};
+static const DisplayField_t Layout[NUM_FIELDS] = {
+  {1, 1, 4},                    // FIELD_VOLTAGE
+  {1, 8, 4},                    // FIELD_CURRENT
+  {1, 15, 3},                   // FIELD_TEMPERATURE
+  {2, 12, 6},                   // FIELD_CHARGE
+  {3, 12, 8}                    // FIELD_TIME
+};
+#else
+static const char * const StatusLines[MAX_ROW] = {
+  "    V    A    \337C"
+};
+static const DisplayField_t Layout[NUM_FIELDS] = {
+  {1, 0, 4},                    // FIELD_VOLTAGE
+  {1, 6, 3},                    // FIELD_CURRENT
+  {1, 11, 3},                   // FIELD_TEMPERATURE
+  {0, 0, 0},                    // FIELD_CHARGE
+  {0, 0, 0}                     // FIELD_TIME
+};
+#endif
 
 //
 // Maximum ADC value + 1
@@ -59,78 +125,272 @@ static const uint32_t ADC_MAX_COUNT = (1 << ADC_BITS);
 static uint32_t FastVoltage_mV, BattVoltage_mV, BattCurrent_mA;
 
 /**
- * @brief Convert binary to BCD for display.
- * @details Binary values less than 100,000 decimal are converted to BCD. The
- * resulting BCD values are packed into a 32-bit integer. There may be up to
- * five valid BCD values.
- *
- * @param[in] binary_value binary integer to be converted to BCD
- * @return    packed BCD representation
+ * @var Mode1Voltage_mV
+ * @brief ::MODE1_VOLTAGE_MV, compensated for the battery temperature.
+ * @var Mode2Voltage_mV
+ * @brief ::MODE2_VOLTAGE_MV, compensated for the battery temperature.
+ * @var Mode3Voltage_mV
+ * @brief ::MODE3_VOLTAGE_MV, compensated for the battery temperature.
+ * @details These are recalculated only when a new temperature reading
+ * arrives. Until the first reading they hold the uncompensated values.
+ */
+static uint32_t Mode1Voltage_mV = MODE1_VOLTAGE_MV;
+static uint32_t Mode2Voltage_mV = MODE2_VOLTAGE_MV;
+static uint32_t Mode3Voltage_mV = MODE3_VOLTAGE_MV;
+
+/**
+ * @var Mode1Current_mA
+ * @brief ::MODE1_CURRENT_MA, derated for the predicted hottest sensor
+ * temperature.
+ * @var TrendTicks
+ * @brief Counts down the SysTicks to the next temperature trend sample.
+ */
+static uint32_t Mode1Current_mA = MODE1_CURRENT_MA;
+static uint32_t TrendTicks;
+
+//
+// Charge, in mA times SysTicks, that makes up one mAh
+//
+static const uint32_t MA_TICKS_PER_MAH = TICKS_PER_SEC * 3600;
+
+/**
+ * @var Charge_mAh
+ * @brief The charge delivered to the battery since reset, in mAh.
+ * @var ChargeRemainder
+ * @brief Charge delivered beyond ::Charge_mAh, in mA times SysTicks.
  */
-static uint32_t Binary2BCD(uint32_t binary_value)
+static uint32_t Charge_mAh, ChargeRemainder;
+
+/**
+ * @brief A length of time, kept as separate counters so that it can be shown
+ * without dividing.
+ */
+typedef struct
 {
-  uint32_t bcd_value = 0;
+  uint32_t Ticks;               ///< SysTicks beyond Seconds
+  uint32_t Seconds;             ///< Seconds beyond Minutes
+  uint32_t Minutes;             ///< Minutes beyond Hours
+  uint32_t Hours;               ///< Whole hours
+} Duration_t;
 
-  while (binary_value > 9999) {
-    bcd_value += 0x10000;
-    binary_value -= 10000;
-  }
-  while (binary_value > 999) {
-    bcd_value += 0x1000;
-    binary_value -= 1000;
-  }
-  while (binary_value > 99) {
-    bcd_value += 0x100;
-    binary_value -= 100;
-  }
-  while (binary_value > 9) {
-    bcd_value += 0x10;
-    binary_value -= 10;
+/**
+ * @var ChargeTime
+ * @brief Time spent charging since reset.
+ * @var StageTime
+ * @brief Time spent in each charging stage, indexed by State - CC_CHARGE.
+ */
+static Duration_t ChargeTime;
+static Duration_t StageTime[TRICKLE - CC_CHARGE + 1];
+
+//
+// Energy, in uW times SysTicks, that makes up one mWh
+//
+static const uint32_t UW_TICKS_PER_MWH = TICKS_PER_SEC * 3600 * 1000;
+
+/**
+ * @var Energy_dWh
+ * @brief The energy delivered to the battery since reset, in tenths of Wh.
+ * @var Energy_mWh
+ * @brief Energy delivered beyond ::Energy_dWh, in mWh.
+ * @var EnergyRemainder
+ * @brief Energy delivered beyond ::Energy_mWh, in uW times SysTicks.
+ */
+static uint32_t Energy_dWh, Energy_mWh, EnergyRemainder;
+
+/**
+ * @var MinTemperature
+ * @brief The lowest battery temperature seen since reset.
+ * @var MaxTemperature
+ * @brief The highest battery temperature seen since reset.
+ * @var TemperatureSeen
+ * @brief Non-zero once ::MinTemperature and ::MaxTemperature are valid.
+ */
+static int32_t MinTemperature, MaxTemperature;
+static uint32_t TemperatureSeen;
+
+/**
+ * @var Page
+ * @brief The page shown below the top row while charging, one of
+ * ::DisplayPageIndex.
+ * @var ButtonTicks
+ * @brief Counts the SysTicks that Button 1 has been held, up to
+ * ::BUTTON_DEBOUNCE_TICKS.
+ */
+static uint32_t Page;
+static uint32_t ButtonTicks;
+
+//
+// Button 1 must be held this many SysTicks to count as a press
+//
+static const uint32_t BUTTON_DEBOUNCE_TICKS = 3;
+
+/**
+ * @brief Adds one SysTick to a length of time.
+ *
+ * @param[in,out] t the time
+ */
+static void CountTime(Duration_t *t)
+{
+  if (++t->Ticks == TICKS_PER_SEC) {
+    t->Ticks = 0;
+    if (++t->Seconds == 60) {
+      t->Seconds = 0;
+      if (++t->Minutes == 60) {
+        t->Minutes = 0;
+        t->Hours++;
+      }
+    }
   }
-  bcd_value += binary_value;
-  return bcd_value;
+}
+
+/**
+ * @brief Writes hours and minutes as text.
+ * @details The hours take two characters, then the minutes take the two
+ * characters after the colon, which must already be in place.
+ *
+ * @param[out] dest the first character of the hours
+ * @param[in] t the time
+ */
+static void FormatTime(char *dest, const Duration_t *t)
+{
+  Format_Fixed(&dest[0], 2, t->Hours, 0, 0);
+  Format_Fixed(&dest[3], 2, t->Minutes, 0, FORMAT_ZERO_PAD);
+}
+
+/**
+ * @brief Finds the text of a display field.
+ *
+ * @param[in] field one of ::DisplayFieldIndex
+ * @return pointer to the first character of the field in ::DisplayLines
+ */
+static char *FieldText(uint32_t field)
+{
+  return &DisplayLines[Layout[field].Row][Layout[field].Col];
+}
+
+/**
+ * @brief Shows "--", right-justified, in a field that has no reading.
+ *
+ * @param[out] dest the first character of the field
+ * @param[in] width number of characters in the field, at least 2
+ */
+static void ShowNoReading(char *dest, uint32_t width)
+{
+  uint32_t i;
+
+  for (i = 0; i < width - 2; i++)
+    dest[i] = ' ';
+  dest[i++] = '-';
+  dest[i] = '-';
 }
 
 /**
  * @brief Inserts ASCII values for measurements into LCD output string.
- * @details There are two global variables, ::TopLine and ::BottomLine
- * that contain the text that is displayed on the LCD while charging is in
- * progress. This function converts the binary values of the voltage, current
- * and temperature measurements to BCD and then inserts those ASCII characters
- * at the correct positions in ::BottomLine
+ * @details The global variable ::DisplayLines contains the text that is
+ * displayed on the LCD while charging is in progress. This function converts
+ * the binary values of the measurements to text, in place in ::DisplayLines,
+ * at the positions given by ::Layout. Fields with no width are skipped. The
+ * conversions do not divide, so this takes the same time on every tick.
  *
- * The resolution of the output string is 0.1V, 0.1A, and 1.0C.
+ * The resolution of the output string is 0.1V, 0.1A, 1.0C and 0.001Ah.
+ * Leading zeros are not shown. The temperature is shown from -99C to 999C,
+ * and the sign is placed just in front of the first digit. With no battery
+ * temperature reading it is shown as "--".
  *
  * @todo Increase voltage display accuracy in calibration mode, do not
  *       display current (or temperature?)
- * @todo Remove leading zero for temperatures less than 10C
- * @todo Handle negative temperatures
  */
 static void DisplayMeasurements()
 {
-  uint32_t temp;
+  char *p;
 
   // round to tenths of volts
-  temp = Binary2BCD(BattVoltage_mV + 50);
-  BottomLine[3] = (char) ((temp >> 8) & 0xF) + '0';
-  BottomLine[1] = (char) ((temp >> 12) & 0xF) + '0';
-  BottomLine[0] = (char) ((temp >> 16) & 0xF) + '0';
+  Format_Fixed(FieldText(FIELD_VOLTAGE), Layout[FIELD_VOLTAGE].Width,
+               Format_Div100(BattVoltage_mV + 50), 1, 0);
 
   // round to tenths of amperes
-  temp = Binary2BCD(BattCurrent_mA + 50);
-  BottomLine[8] = (char) ((temp >> 8) & 0xF) + '0';
-  BottomLine[6] = (char) ((temp >> 12) & 0xF) + '0';
-
-  BottomLine[14] = 0xdf;              // degree symbol
-  temp = Binary2BCD(Temperature);
-  BottomLine[13] = (char) (temp & 0xF) + '0';
-  BottomLine[12] = (char) ((temp >> 4) & 0xF) + '0';
+  Format_Fixed(FieldText(FIELD_CURRENT), Layout[FIELD_CURRENT].Width,
+               Format_Div100(BattCurrent_mA + 50), 1, 0);
+
+  // round to whole degrees, if there is a reading
+  if (TEMP_NONE == Temperature)
+    ShowNoReading(FieldText(FIELD_TEMPERATURE),
+                  Layout[FIELD_TEMPERATURE].Width);
+  else
+    Format_Fixed(FieldText(FIELD_TEMPERATURE),
+                 Layout[FIELD_TEMPERATURE].Width,
+                 (Temperature + (1 << (TEMP_FRAC_BITS - 1))) >>
+                 TEMP_FRAC_BITS, 0, 0);
+
+  if (Layout[FIELD_CHARGE].Width != 0)
+    Format_Fixed(FieldText(FIELD_CHARGE), Layout[FIELD_CHARGE].Width,
+                 Charge_mAh, 3, 0);
+
+  if (Layout[FIELD_TIME].Width != 0) {
+    p = FieldText(FIELD_TIME);
+    Format_Fixed(&p[0], 2, ChargeTime.Hours, 0, FORMAT_ZERO_PAD);
+    Format_Fixed(&p[3], 2, ChargeTime.Minutes, 0, FORMAT_ZERO_PAD);
+    Format_Fixed(&p[6], 2, ChargeTime.Seconds, 0, FORMAT_ZERO_PAD);
+  }
+}
+
+//
+// The progress bar fills the top line after a 3-character stage label. The
+// first half of the bar follows the voltage rise in CC_CHARGE and the second
+// half follows the current taper in CV_CHARGE. The scale factors turn a
+// voltage or current difference into bar steps with a multiply and a shift.
+//
+#define BAR_CELLS  (MAX_COL - 2)
+#define BAR_FULL   (BAR_CELLS * LCD_BAR_STEPS)
+#define BAR_HALF   (BAR_FULL / 2)
+static const uint32_t BAR_CC_SCALE =
+  (BAR_HALF << 16) / (MODE1_VOLTAGE_MV - SHORT_VOLTAGE_MV);
+static const uint32_t BAR_CV_SCALE =
+  (BAR_HALF << 16) / (MODE1_CURRENT_MA - MODE2_CURRENT_MA);
+
+/**
+ * @brief Shows the charging stage and a progress bar on the top line.
+ * @details The bar is based on the nominal stage limits, so it is only a
+ * guide; it is held at half full until the charger enters CV_CHARGE, and it
+ * is full in TRICKLE.
+ */
+static void DisplayProgress()
+{
+  uint32_t fill = BAR_FULL;
+
+  switch (State) {
+    case CC_CHARGE:
+      TopLine[0] = 'C';
+      TopLine[1] = 'C';
+      fill = 0;
+      if (BattVoltage_mV > SHORT_VOLTAGE_MV)
+        fill = ((BattVoltage_mV - SHORT_VOLTAGE_MV) * BAR_CC_SCALE) >> 16;
+      if (fill > BAR_HALF)
+        fill = BAR_HALF;
+      break;
+    case CV_CHARGE:
+      TopLine[0] = 'C';
+      TopLine[1] = 'V';
+      fill = BAR_HALF;
+      if (BattCurrent_mA < MODE1_CURRENT_MA)
+        fill += ((MODE1_CURRENT_MA - BattCurrent_mA) * BAR_CV_SCALE) >> 16;
+      if (fill > BAR_FULL)
+        fill = BAR_FULL;
+      break;
+    case TRICKLE:
+      TopLine[0] = 'T';
+      TopLine[1] = 'C';
+      break;
+  }
+  TopLine[2] = ' ';
+  LCD_Bar(&TopLine[3], BAR_CELLS, fill);
 }
 
 /**
  * @brief Copies ASCII text to a specified location.
- * @details This is a simple string copying function. The strings are assumed
- * to have ::MAX_COL +1 characters.
+ * @details This is a simple string copying function. The destination has
+ * ::MAX_COL +1 characters, and if the source is shorter the rest of the
+ * destination is filled with spaces.
  *
  * @param[out] dest pointer to destination characters
  * @param[in] src pointer to source characters
@@ -138,19 +398,166 @@ static void DisplayMeasurements()
 static void CopyLine(char *dest, const char *src)
 {
   uint32_t i;
-  for (i = 0; i <= MAX_COL; i++)
+  for (i = 0; (i <= MAX_COL) && (src[i] != '\0'); i++)
     dest[i] = src[i];
+  for (; i <= MAX_COL; i++)
+    dest[i] = ' ';
+}
+
+/**
+ * @brief Puts the text for the running charger below the top row.
+ * @details This writes the labels for every field in ::Layout, so it must
+ * come before DisplayMeasurements() in any state that shows them.
+ */
+static void ShowStatusLines()
+{
+  uint32_t row;
+
+  for (row = 1; row <= MAX_ROW; row++)
+    CopyLine(DisplayLines[row], StatusLines[row - 1]);
+}
+
+/**
+ * @brief Inserts the charge and energy delivered into ::BottomLine.
+ */
+static void DisplayEnergy()
+{
+  Format_Fixed(&BottomLine[0], 6, Charge_mAh, 3, 0);
+  Format_Fixed(&BottomLine[8], 6, Energy_dWh, 1, 0);
+}
+
+/**
+ * @brief Inserts the time spent in CC_CHARGE and CV_CHARGE into ::BottomLine.
+ */
+static void DisplayStageTimes()
+{
+  FormatTime(&BottomLine[2], &StageTime[CC_CHARGE - CC_CHARGE]);
+  FormatTime(&BottomLine[11], &StageTime[CV_CHARGE - CC_CHARGE]);
+}
+
+/**
+ * @brief Inserts the time spent in TRICKLE into ::BottomLine.
+ */
+static void DisplayTrickleTime()
+{
+  FormatTime(&BottomLine[11], &StageTime[TRICKLE - CC_CHARGE]);
+}
+
+/**
+ * @brief Inserts the lowest and highest battery temperatures into
+ * ::BottomLine, rounded to whole degrees, or "--" before the first reading.
+ */
+static void DisplayTemperatureRange()
+{
+  if (TemperatureSeen) {
+    Format_Fixed(&BottomLine[2], 3,
+                 (MinTemperature + (1 << (TEMP_FRAC_BITS - 1))) >>
+                 TEMP_FRAC_BITS, 0, 0);
+    Format_Fixed(&BottomLine[11], 3,
+                 (MaxTemperature + (1 << (TEMP_FRAC_BITS - 1))) >>
+                 TEMP_FRAC_BITS, 0, 0);
+  } else {
+    ShowNoReading(&BottomLine[2], 3);
+    ShowNoReading(&BottomLine[11], 3);
+  }
+}
+
+/**
+ * @brief Inserts the number of failed or lost temperature readings into
+ * ::BottomLine.
+ */
+static void DisplayFaults()
+{
+  uint32_t i;
+  uint32_t errors = SensorEvents.Dropped;
+
+  for (i = 0; i < LM75_MAX_SENSORS; i++)
+    errors += LM75Sensors[i].Errors;
+  Format_Fixed(&BottomLine[13], 3, errors, 0, 0);
+}
+
+/**
+ * @brief One page of text shown below the top row while charging.
+ */
+typedef struct
+{
+  const char *Text;             ///< Labels for row 1, NULL for ::StatusLines
+  void (*Render)(void);         ///< Inserts the values, every SysTick
+} DisplayPage_t;
+
+//
+// The pages that Button 1 steps through while charging, indexing Pages
+//
+enum DisplayPageIndex {
+  PAGE_STATUS,
+  PAGE_ENERGY,
+  PAGE_STAGE_TIMES,
+  PAGE_TRICKLE_TIME,
+  PAGE_TEMPERATURE_RANGE,
+  PAGE_FAULTS,
+  NUM_PAGES
+};
+
+//
+// Only the page being shown is rendered, so a page costs nothing while it is
+// hidden. Every page but the first fits in 16 characters on row 1.
+//
+static const DisplayPage_t Pages[NUM_PAGES] = {
+  {0, DisplayMeasurements},
+  {"      Ah      Wh", DisplayEnergy},
+  {"CC  :    CV  :  ", DisplayStageTimes},
+  {"Trickle      :  ", DisplayTrickleTime},
+  {"Lo   \337C  Hi   \337C", DisplayTemperatureRange},
+  {"Sensor errors   ", DisplayFaults}
+};
+
+/**
+ * @brief Puts the labels of the current page below the top row.
+ */
+static void ShowPage()
+{
+  uint32_t row;
+
+  if (Pages[Page].Text == 0) {
+    ShowStatusLines();
+  } else {
+    CopyLine(BottomLine, Pages[Page].Text);
+    for (row = 2; row <= MAX_ROW; row++)
+      CopyLine(DisplayLines[row], "");
+  }
+}
+
+/**
+ * @brief Moves to the next page each time Button 1 is pressed.
+ * @details A press counts once the button has been held for
+ * ::BUTTON_DEBOUNCE_TICKS, and the button must be released before it can
+ * count again.
+ */
+static void CheckPageButton()
+{
+  if (!BUTTON1_PRESSED) {
+    ButtonTicks = 0;
+  } else if (ButtonTicks < BUTTON_DEBOUNCE_TICKS) {
+    if (++ButtonTicks == BUTTON_DEBOUNCE_TICKS) {
+      if (++Page == NUM_PAGES)
+        Page = 0;
+      ShowPage();
+    }
+  }
 }
 
 /**
  * @brief Error handler.
  * @details Disable the PWM output, change the charger state to the ERROR
  * state, and put an error message on the first line of the display.
+ *
+ * @param[in] fault the reason for stopping, one of ::ChargerFault
  */
-static void Error()
+static void Error(uint32_t fault)
 {
   PWM_Stop();
   State = ERROR;
+  Fault = fault;
   CopyLine(TopLine, "Charging stopped");
 }
 
@@ -165,6 +572,9 @@ static void Error()
   the first statement of the handler and is then cleared to 0 as the last
   statement in the handler.
 
+  New sensor readings are taken from the ::SensorEvents queue, which is filled
+  when each I2C sensor read completes.
+
   Raw current and voltage readings have been accumulated by the ADC interrupt
   handler, they get converted to actual voltage and current values here. The
   ADC interrupt uses moving-average filters to smooth the voltage/current data
@@ -207,22 +617,85 @@ static void Error()
   current falls below MODE2_CURRENT_MA, and then the charger transitions to
   the TRICKLE mode.
 
+  The voltages used in the CC_CHARGE, CV_CHARGE, and TRICKLE states are
+  adjusted for the battery temperature each time a new temperature reading is
+  collected, lower for a warm battery and higher for a cold one. The current
+  used in the CC_CHARGE state is reduced if the hottest temperature sensor is
+  predicted to become too hot, and charging stops if it actually does.
+
   The TRICKLE state is also a constant-voltage state, but the desired charging
   voltage is significantly lower than in the CV_CHARGE state. The charger
   remains in this state indefinitely, until the processor is reset or a faulty
   voltage is measured at the battery terminals.
 
+  While the charger is in the CC_CHARGE, CV_CHARGE, or TRICKLE state each
+  press of Button 1 shows the next page of session statistics below the top
+  row. Only the page that is shown is updated.
+
   In addition to maintaining the charger state, the SysTick interrupt handler
-  writes one character to the LCD every time it is activated.
+  updates the text in DisplayLines and publishes it as a complete frame. The
+  main loop copies any changes to the LCD.
+
+  The control and LCD paths check in with the watchdog deadline monitor, and
+  then the watchdog is serviced. It is only fed if every supervised task has
+  checked in on time.
 
   Finally, the Ticks variable is incremented. If the Ticks counter reaches the
   number of SysTick interrupts in one second then it will be cleared. The Ticks
   counter is used to control activities that happen at a very low rate, such
-  as reading the temperature sensor.
+  as reading the temperature sensor. The TickCount variable is also
+  incremented, and it is never cleared.
  */
 void SysTick_Handler(void)
 {
+  Event_t event;
+  uint32_t sensor;
+  int32_t offset_mV;
+#if WCET_MEASUREMENT
+  uint32_t start = WCET_Start();
+  uint32_t path = WCET_SYSTICK + State;
+#endif
+
+#if JITTER_MEASUREMENT
+  Jitter_SysTick();
+#endif
   FLAG1_PORT->DATA |= FLAG1_Msk;
+  WDT_CheckIn(WDT_TASK_CONTROL);
+  //
+  // Collect new sensor readings
+  //
+  while (Queue_Get(&SensorEvents, &event)) {
+    if ((event.Type >= EVENT_TEMPERATURE) &&
+        (event.Type <= EVENT_TEMPERATURE_LAST)) {
+      sensor = event.Type - EVENT_TEMPERATURE;
+      LM75_Filter(sensor, event.Value);
+      if (sensor == LM75BatterySensor) {
+        Temperature = LM75Sensors[sensor].Temperature;
+        if (!TemperatureSeen || (Temperature < MinTemperature))
+          MinTemperature = Temperature;
+        if (!TemperatureSeen || (Temperature > MaxTemperature))
+          MaxTemperature = Temperature;
+        TemperatureSeen = 1;
+        offset_mV = TempComp_Offset(Temperature);
+        Mode1Voltage_mV = TempComp_Setpoint(MODE1_VOLTAGE_MV, offset_mV);
+        Mode2Voltage_mV = TempComp_Setpoint(MODE2_VOLTAGE_MV, offset_mV);
+        Mode3Voltage_mV = TempComp_Setpoint(MODE3_VOLTAGE_MV, offset_mV);
+      }
+    }
+  }
+  LM75_Expire();
+  if (!LM75Sensors[LM75BatterySensor].Valid)
+    Temperature = TEMP_NONE;
+  HottestTemperature = LM75_Hottest();
+  //
+  // Derate the charging current if the temperature is heading too high
+  //
+  if (0 == TrendTicks) {
+    TrendTicks = TEMP_TREND_SEC * TICKS_PER_SEC;
+    Mode1Current_mA = TempComp_Derate(MODE1_CURRENT_MA,
+                                      TempComp_Predict(HottestTemperature));
+  }
+  TrendTicks--;
   //
   // Convert raw ADC data to voltages and current
   //
@@ -241,15 +714,30 @@ void SysTick_Handler(void)
     case CC_CHARGE:
     case CV_CHARGE:
     case TRICKLE:
-      DisplayMeasurements();
+      CheckPageButton();
+      Pages[Page].Render();
       if (FastVoltage_mV < SHORT_VOLTAGE_MV) {
-        Error();
+        Error(FAULT_SHORT);
         CopyLine(BottomLine, "Short/no battery");
       }
       if (FastVoltage_mV > OPEN_VOLTAGE_MV) {
-        Error();
+        Error(FAULT_OPEN);
         CopyLine(BottomLine, "Open, no battery");
       }
+      if (HottestTemperature >= TEMP_FAULT_C * (1 << TEMP_FRAC_BITS)) {
+        Error(FAULT_OVERTEMP);
+        CopyLine(BottomLine, "Over temperature");
+      }
+      if ((0 != LM75SensorCount) && LM75Sensors[LM75BatterySensor].Lost) {
+        Error(FAULT_SENSOR);
+        CopyLine(BottomLine, "Temp sensor lost");
+      }
+#if !TEMP_SENSOR_OPTIONAL
+      if (0 == LM75SensorCount) {
+        Error(FAULT_SENSOR);
+        CopyLine(BottomLine, "No temp sensor");
+      }
+#endif
       break;
   }
   //
@@ -258,7 +746,7 @@ void SysTick_Handler(void)
   switch (State) {
     case CALIBRATE:
       CopyLine(TopLine, "Calibration mode");
-      CopyLine(BottomLine, "00.0V           ");
+      ShowStatusLines();
       DisplayMeasurements();
       break;
     case WAIT4BUTTON:
@@ -266,44 +754,42 @@ void SysTick_Handler(void)
       CopyLine(BottomLine, "  start charging");
       if (BUTTON1_PRESSED) {
         State = CHECK4BATT;
+        ButtonTicks = BUTTON_DEBOUNCE_TICKS;  // not a page step
       }
       break;
     case CHECK4BATT:
       State = CC_CHARGE;
-      CopyLine(TopLine, "Constant Current");
-      CopyLine(BottomLine, StatusLine);
+      ShowPage();
       PWM_Start();
       break;
     case CC_CHARGE:
-      if (BattVoltage_mV < MODE1_VOLTAGE_MV) {
-        if (BattCurrent_mA < MODE1_CURRENT_MA) {
+      if (BattVoltage_mV < Mode1Voltage_mV) {
+        if (BattCurrent_mA < Mode1Current_mA) {
           PWM_IncreaseDutyCycle();
-        } else if (BattCurrent_mA > MODE1_CURRENT_MA) {
+        } else if (BattCurrent_mA > Mode1Current_mA) {
           PWM_DecreaseDutyCycle();
         }
       } else {
         State = CV_CHARGE;
-        CopyLine(TopLine, "Constant Voltage");
-        CopyLine(BottomLine, StatusLine);
+        ShowPage();
       }
       break;
     case CV_CHARGE:
       if (BattCurrent_mA > MODE2_CURRENT_MA) {
-        if (BattVoltage_mV < MODE2_VOLTAGE_MV) {
+        if (BattVoltage_mV < Mode2Voltage_mV) {
           PWM_IncreaseDutyCycle();
-        } else if (BattVoltage_mV > MODE2_VOLTAGE_MV) {
+        } else if (BattVoltage_mV > Mode2Voltage_mV) {
           PWM_DecreaseDutyCycle();
         }
       } else {
         State = TRICKLE;
-        CopyLine(TopLine, "Trickle Charge  ");
-        CopyLine(BottomLine, StatusLine);
+        ShowPage();
       }
       break;
     case TRICKLE:
-      if (BattVoltage_mV < MODE3_VOLTAGE_MV) {
+      if (BattVoltage_mV < Mode3Voltage_mV) {
         PWM_IncreaseDutyCycle();
-      } else if (BattVoltage_mV > MODE3_VOLTAGE_MV) {
+      } else if (BattVoltage_mV > Mode3Voltage_mV) {
         PWM_DecreaseDutyCycle();
       }
       break;
@@ -312,12 +798,55 @@ void SysTick_Handler(void)
       CopyLine(TopLine, "Charging stopped");
       break;
   }
+  if ((State == CC_CHARGE) || (State == CV_CHARGE) || (State == TRICKLE))
+    DisplayProgress();
+  //
+  // Count the charge, energy and time delivered while the PWM is running
+  //
+  switch (State) {
+    case CC_CHARGE:
+    case CV_CHARGE:
+    case TRICKLE:
+      ChargeRemainder += BattCurrent_mA;
+      if (ChargeRemainder >= MA_TICKS_PER_MAH) {
+        ChargeRemainder -= MA_TICKS_PER_MAH;
+        Charge_mAh++;
+      }
+      EnergyRemainder += BattVoltage_mV * BattCurrent_mA;
+      if (EnergyRemainder >= UW_TICKS_PER_MWH) {
+        EnergyRemainder -= UW_TICKS_PER_MWH;
+        if (++Energy_mWh == 100) {
+          Energy_mWh = 0;
+          Energy_dWh++;
+        }
+      }
+      CountTime(&ChargeTime);
+      CountTime(&StageTime[State - CC_CHARGE]);
+      break;
+  }
+  //
+  // The display text for this tick is complete, let the LCD writer have it
+  //
+  LCD_Publish();
+#if I2C_SLAVE_ENABLE
+  RegMap_Update(BattVoltage_mV, BattCurrent_mA, Charge_mAh);
+#endif
+#if TELEMETRY_ENABLE
+  Telemetry_Update(BattVoltage_mV, BattCurrent_mA);
+#endif
 
-  LCD_WriteNextChar();
+  WDT_Service();
 
+  TickCount++;
   Ticks++;
   if (Ticks == TICKS_PER_SEC) Ticks = 0;
 
+#if WCET_MEASUREMENT
+  if ((ERROR == State) && (WCET_SYSTICK + ERROR != path))
+    path = WCET_SYSTICK_FAULT;
+  WCET_Record(path, start);
+#endif
+
   FLAG1_PORT->DATA &= ~FLAG1_Msk;
   return;
 }
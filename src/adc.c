@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-07T19:39:03-0500
- * @date Last modified: 2014-01-12T18:04:47-0500
+ * @date Last modified: 2026-10-19T11:58:31-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -23,6 +23,9 @@
 #include "LPC11xx.h"
 #include "charger.h"
 #include "adc.h"
+#include "wdt.h"
+#include "jitter.h"
+#include "wcet.h"
 //
 // ADC Control Register, LPC_ADC->CR
 //
@@ -145,9 +148,11 @@ void ADC_Init()
 
   /**
    * Enable ADC interrupts. Interrupt will occur when the highest-numbered
-   * channel finishes a conversion. Also enable the NVIC IRQ for the ADC.
+   * channel finishes a conversion. Also set the priority of the ADC interrupt
+   * and enable the NVIC IRQ for the ADC.
    */
   LPC_ADC->INTEN = (1 << HIGHEST_CHANNEL);
+  NVIC_SetPriority(ADC_IRQn, ADC_IRQ_PRIORITY);
   NVIC_EnableIRQ(ADC_IRQn);
   return;
 }
@@ -168,10 +173,19 @@ void ADC_Init()
  * data is discarded. In the future we should use this channel to calibrate
  * the ADC, since the ADC's reference voltage is just the microcontroller's
  * supply voltage.
+ *
+ * Each pass through this handler checks in with the watchdog deadline
+ * monitor, so a stalled ADC will stop the charger.
  */
 void ADC_IRQHandler()
 {
   uint32_t temp;
+#if WCET_MEASUREMENT
+  uint32_t start = WCET_Start();
+#endif
+#if JITTER_MEASUREMENT
+  Jitter_ADC();
+#endif
   temp = LPC_ADC->STAT;         // clear the interrupt
 
   temp = (LPC_ADC->DR[CURRENT_CHANNEL] & ADC_DR_DATA_Msk) >> ADC_DR_DATA_Pos;
@@ -183,5 +197,10 @@ void ADC_IRQHandler()
 
   temp = (LPC_ADC->DR[VREF_25_CHANNEL] & ADC_DR_DATA_Msk) >> ADC_DR_DATA_Pos;
   temp = LPC_ADC->STAT;         // clear the interrupt
+
+  WDT_CheckIn(WDT_TASK_ADC);
+#if WCET_MEASUREMENT
+  WCET_Record(WCET_ADC, start);
+#endif
   return;
 }
@@ -0,0 +1,157 @@
+/**
+ * @file format.c
+ *
+ * @brief Converts numbers to text for the display without dividing.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T19:22:18-0400
+ * @date Last modified: 2026-10-20T15:02:40-0400
+ *
+ * @details The Cortex-M0 has no divide instruction, and the library divide
+ * takes a time that depends on its operands. Here each decimal digit is found
+ * by multiplying by a scaled reciprocal of 10 and shifting, which takes the
+ * same few cycles for any value. A field of @e width characters always costs
+ * @e width passes through the loops, so the display update in the SysTick
+ * handler takes a fixed time.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "format.h"
+
+//
+// 2^19 / 10, rounded up. The value is halved first, so that its product with
+// any value up to FORMAT_MAX fits in 32 bits, and the shifted product is then
+// exactly value / 10.
+//
+static const uint32_t RECIP10 = 0xCCCD;
+static const uint32_t RECIP10_SHIFT = 18;
+
+//
+// 2^19 / 100, rounded up, which is exact up to FORMAT_DIV100_MAX
+//
+static const uint32_t RECIP100 = 0x147B;
+static const uint32_t RECIP100_SHIFT = 19;
+
+static inline uint32_t Div10(uint32_t value)
+{
+  return ((value >> 1) * RECIP10) >> RECIP10_SHIFT;
+}
+
+/**
+ * @brief Divide by 10.
+ *
+ * @param[in] value the dividend, no more than ::FORMAT_MAX
+ * @return value / 10, rounded down
+ */
+uint32_t Format_Div10(uint32_t value)
+{
+  return Div10(value);
+}
+
+/**
+ * @brief Divide by 100.
+ * @details One multiply instead of two calls of Format_Div10(), for turning
+ * millivolts and milliamperes into tenths.
+ *
+ * @param[in] value the dividend, no more than ::FORMAT_DIV100_MAX
+ * @return value / 100, rounded down
+ */
+uint32_t Format_Div100(uint32_t value)
+{
+  return (value * RECIP100) >> RECIP100_SHIFT;
+}
+
+/*
+ * Fill a field that the number or its sign does not fit, rather than show a
+ * wrong value
+ */
+static void Overflow(char *dest, uint32_t width)
+{
+  while (width != 0)
+    dest[--width] = '*';
+}
+
+/**
+ * @brief Write a number as text.
+ * @details The number is right-justified in a field of @p width characters,
+ * with a decimal point before the last @p decimals digits. Leading zeros are
+ * replaced by spaces, except for the zero in front of the decimal point, and
+ * a minus sign goes just before the first digit. No terminating null is
+ * written. If the number does not fit, the field is filled with '*'.
+ *
+ * @param[out] dest the first character of the field
+ * @param[in] width number of characters in the field
+ * @param[in] value the number, in units of 10^-decimals
+ * @param[in] decimals number of digits after the decimal point
+ * @param[in] flags ::FORMAT_ZERO_PAD, or 0
+ */
+void Format_Fixed(char *dest, uint32_t width, int32_t value,
+                  uint32_t decimals, uint32_t flags)
+{
+  uint32_t magnitude = (value < 0) ? 0 - (uint32_t) value : (uint32_t) value;
+  uint32_t i = width;
+  uint32_t quotient;
+
+  //
+  // The digits after the point, the point and the units digit must fit.
+  // Past those, the room left is tested only when another digit or the
+  // sign is still to be written.
+  //
+  if ((magnitude > FORMAT_MAX) || (width <= decimals + (decimals != 0))) {
+    Overflow(dest, width);
+    return;
+  }
+  if (decimals != 0) {
+    do {
+      quotient = Div10(magnitude);
+      dest[--i] = (char) (magnitude - quotient * 10) + '0';
+      magnitude = quotient;
+    } while (--decimals != 0);
+    dest[--i] = '.';
+  }
+  for (;;) {
+    quotient = Div10(magnitude);
+    dest[--i] = (char) (magnitude - quotient * 10) + '0';
+    magnitude = quotient;
+    if (0 == magnitude)
+      break;
+    if (0 == i) {
+      Overflow(dest, width);
+      return;
+    }
+  }
+  if (value < 0) {
+    if (0 == i) {
+      Overflow(dest, width);
+      return;
+    }
+    if (flags & FORMAT_ZERO_PAD) {
+      *dest++ = '-';
+      i--;
+    } else {
+      dest[--i] = '-';
+    }
+  }
+  //
+  // The fill is only worked out when there is room left for it
+  //
+  if (i != 0) {
+    char fill = (flags & FORMAT_ZERO_PAD) ? '0' : ' ';
+
+    do
+      dest[--i] = fill;
+    while (i != 0);
+  }
+}
@@ -27,11 +27,29 @@
 ****************************************************************************/
 #include "LPC11xx.h"			/* LPC11xx Peripheral Registers */
 #include "stdint.h"
+#include "charger.h"
+#include "SysTick.h"
 #include "i2c.h"
+#include "jitter.h"
+#include "wcet.h"
+#include "regmap.h"
 
 volatile uint32_t I2CMasterState = I2C_IDLE;
 volatile uint32_t I2CSlaveState = I2C_IDLE;
-volatile uint32_t timeout = 0;
+volatile uint32_t I2CStartTick = 0;
+volatile uint32_t I2CStatusCount[I2C_OK + 1];
+volatile uint32_t I2CBusRecoveries = 0;
+volatile uint32_t I2CByteCount = 0;
+static uint32_t I2CMode = I2CMASTER;
+
+/* Timeout in SysTicks, rounded up, plus one for the partial first tick */
+static const uint32_t I2C_TIMEOUT_TICKS =
+	(I2C_TIMEOUT_MS * TICKS_PER_SEC + 999) / 1000 + 1;
+
+/* Bit-banged clock pulses needed to free a slave holding SDA low */
+static const uint32_t I2C_RECOVERY_CLOCKS = 9;
+static const uint32_t I2C_SCL_PIN = (0x1<<4);		/* PIO0_4 */
+static const uint32_t I2C_SDA_PIN = (0x1<<5);		/* PIO0_5 */
 
 volatile uint8_t I2CMasterBuffer[BUFSIZE];
 volatile uint8_t I2CSlaveBuffer[BUFSIZE];
@@ -42,20 +60,192 @@ volatile uint32_t I2CWriteLength;
 volatile uint32_t RdIndex = 0;
 volatile uint32_t WrIndex = 0;
 
+/* Slave mode: register offset and snapshot being sent */
+static uint32_t SlaveIndex = 0;
+static uint32_t SlaveRxCount = 0;
+static const uint8_t *SlaveData = 0;
+
+volatile uint32_t I2CQueueHead = 0;
+volatile uint32_t I2CQueueTail = 0;
+I2CTransaction * volatile I2CQueue[I2C_QUEUE_SIZE];
+I2CTransaction * volatile I2CCurrent = 0;
+
 /* 
-From device to device, the I2C communication protocol may vary, 
-in the example below, the protocol uses repeated start to read data from or 
-write to the device:
-For master read: the sequence is: STA,Addr(W),offset,RE-STA,Addr(r),data...STO 
-for master write: the sequence is: STA,Addr(W),offset,RE-STA,Addr(w),data...STO
-Thus, in state 8, the address is always WRITE. in state 10, the address could 
-be READ or WRITE depending on the I2C command.
+Each transaction is carried out from start to stop by the interrupt handler.
+If there are bytes to write, the sequence is:
+  STA,Addr(W),data...[RE-STA,Addr(R),data...]STO
+and if there are only bytes to read, the sequence is:
+  STA,Addr(R),data...STO
+Thus, in state 8, the address is WRITE unless there is nothing to write. In
+state 10 the address is always READ.
 */   
 
+/*****************************************************************************
+** Function name:		I2CStartNext
+**
+** Descriptions:		Take the next transaction from the queue and
+**				request a start condition for it. Called with
+**				the I2C interrupt disabled, or from the handler.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CStartNext( void )
+{
+  if ( I2CQueueTail != I2CQueueHead )
+  {
+	I2CCurrent = I2CQueue[I2CQueueTail % I2C_QUEUE_SIZE];
+	I2CQueueTail++;
+	I2CStartTick = TickCount;
+	LPC_I2C->CONSET = I2CONSET_STA;	/* Set Start flag */
+  }
+  else
+  {
+	I2CCurrent = 0;
+  }
+}
+
+/*****************************************************************************
+** Function name:		I2CFinish
+**
+** Descriptions:		Complete the current transaction, tell the
+**				caller, and start the next one. If a stop
+**				condition is pending the controller sends it
+**				before the new start condition.
+**
+** parameters:			Final status of the transaction
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CFinish( uint32_t status )
+{
+  I2CTransaction *t = I2CCurrent;
+
+  I2CMasterState = status;
+  I2CStatusCount[status]++;
+  t->Status = status;
+  if ( t->Callback != 0 )
+  {
+	t->Callback( t );
+  }
+  if ( I2CMode & I2CSLAVE )
+  {
+	LPC_I2C->CONSET = I2CONSET_AA;	/* Answer to our slave address again */
+  }
+  I2CStartNext();
+}
+
+/*****************************************************************************
+** Function name:		I2CSlaveHandler
+**
+** Descriptions:		Slave mode states. The first byte written
+**				by the other master selects a register
+**				offset, and reads then return bytes from the
+**				register map starting at that offset. If we
+**				lost arbitration to that master, our own
+**				transaction is ended and STA is left set, so
+**				the next one starts when the bus is free.
+**
+** parameters:			I2C status code
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CSlaveHandler( uint32_t StatValue )
+{
+  switch ( StatValue )
+  {
+	case 0x68:	/* Arbitration lost, own SLA+W received */
+	if ( I2CCurrent != 0 )
+	{
+	  I2CFinish( I2C_ARBITRATION_LOST );
+	}
+	/* fall through */
+	case 0x60:	/* Own SLA+W received, ACK returned */
+	SlaveRxCount = 0;
+	break;
+
+	case 0x80:	/* Data received, ACK returned */
+	case 0x88:	/* Data received, NACK returned */
+	if ( SlaveRxCount++ == 0 )
+	{
+	  SlaveIndex = LPC_I2C->DAT;	/* Register offset; the map is read-only */
+	}
+	break;
+
+	case 0xB0:	/* Arbitration lost, own SLA+R received */
+	if ( I2CCurrent != 0 )
+	{
+	  I2CFinish( I2C_ARBITRATION_LOST );
+	}
+	/* fall through */
+	case 0xA8:	/* Own SLA+R received, ACK returned */
+	SlaveData = RegMap_Acquire();
+	/* fall through */
+	case 0xB8:	/* Data sent, ACK received */
+	if ( SlaveIndex < REGMAP_SIZE )
+	{
+	  LPC_I2C->DAT = SlaveData[SlaveIndex++];
+	}
+	else
+	{
+	  LPC_I2C->DAT = 0xFF;
+	}
+	break;
+
+	case 0xC0:	/* Data sent, NACK received: the read is over */
+	case 0xC8:	/* Last data sent, ACK received */
+	case 0xA0:	/* Stop or repeated start while addressed */
+	default:
+	if ( SlaveData != 0 )
+	{
+	  RegMap_Release();
+	  SlaveData = 0;
+	}
+	break;
+  }
+  LPC_I2C->CONSET = I2CONSET_AA;
+  LPC_I2C->CONCLR = I2CONCLR_SIC;
+}
+
+/*****************************************************************************
+** Function name:		I2CWriteNext
+**
+** Descriptions:		After an address or data byte has been sent
+**				and acknowledged, send the next data byte, a
+**				repeated start for the read phase, or a stop.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CWriteNext( void )
+{
+  I2CTransaction *t = I2CCurrent;
+
+  if ( WrIndex < t->WriteLength )
+  {
+	LPC_I2C->DAT = t->WriteData[WrIndex++];
+	I2CByteCount++;
+  }
+  else if ( t->ReadLength != 0 )
+  {
+	LPC_I2C->CONSET = I2CONSET_STA;	/* Set Repeated-start flag */
+  }
+  else
+  {
+	LPC_I2C->CONSET = I2CONSET_STO;      /* Set Stop flag */
+	I2CFinish( I2C_OK );
+  }
+}
+
 /*****************************************************************************
 ** Function name:		I2C_IRQHandler
 **
-** Descriptions:		I2C interrupt handler, deal with master mode only.
+** Descriptions:		I2C interrupt handler. Carries the current
+**				master transaction through to completion,
+**				and answers reads of the register map when
+**				slave mode is enabled.
 **
 ** parameters:			None
 ** Returned value:		None
@@ -64,66 +254,62 @@ be READ or WRITE depending on the I2C command.
 void I2C_IRQHandler(void) 
 {
   uint8_t StatValue;
+  I2CTransaction *t = I2CCurrent;
+#if WCET_MEASUREMENT
+  uint32_t start = WCET_Start();
+#endif
 
-  timeout = 0;
-  /* this handler deals with master read and master write only */
   StatValue = LPC_I2C->STAT;
-  switch ( StatValue )
+#if JITTER_MEASUREMENT
+  Jitter_I2C(StatValue);
+#endif
+  if ( (I2CMode & I2CSLAVE) && (StatValue >= 0x60) && (StatValue != 0xF8) )
+  {
+	I2CSlaveHandler( StatValue );
+  }
+  else if ( t == 0 )
+  {
+	/* Nothing in progress, release the bus */
+	LPC_I2C->CONSET = I2CONSET_STO;
+	LPC_I2C->CONCLR = (I2CONCLR_SIC | I2CONCLR_STAC);
+  }
+  else switch ( StatValue )
   {
 	case 0x08:			/* A Start condition is issued. */
 	WrIndex = 0;
-	LPC_I2C->DAT = I2CMasterBuffer[WrIndex++];
+	RdIndex = 0;
+	if ( t->WriteLength != 0 )
+	{
+	  LPC_I2C->DAT = t->Address;
+	}
+	else
+	{
+	  LPC_I2C->DAT = t->Address | RD_BIT;
+	}
 	LPC_I2C->CONCLR = (I2CONCLR_SIC | I2CONCLR_STAC);
 	break;
 	
 	case 0x10:			/* A repeated started is issued */
 	RdIndex = 0;
 	/* Send SLA with R bit set, */
-	LPC_I2C->DAT = I2CMasterBuffer[WrIndex++];
+	LPC_I2C->DAT = t->Address | RD_BIT;
 	LPC_I2C->CONCLR = (I2CONCLR_SIC | I2CONCLR_STAC);
 	break;
 	
 	case 0x18:			/* Regardless, it's a ACK */
-	if ( I2CWriteLength == 1 )
-	{
-	  LPC_I2C->CONSET = I2CONSET_STO;      /* Set Stop flag */
-	  I2CMasterState = I2C_NO_DATA;
-	}
-	else
-	{
-	  LPC_I2C->DAT = I2CMasterBuffer[WrIndex++];
-	}
-	LPC_I2C->CONCLR = I2CONCLR_SIC;
-	break;
-	
 	case 0x28:	/* Data byte has been transmitted, regardless ACK or NACK */
-	if ( WrIndex < I2CWriteLength )
-	{   
-	  LPC_I2C->DAT = I2CMasterBuffer[WrIndex++]; /* this should be the last one */
-	}
-	else
-	{
-	  if ( I2CReadLength != 0 )
-	  {
-		LPC_I2C->CONSET = I2CONSET_STA;	/* Set Repeated-start flag */
-	  }
-	  else
-	  {
-		LPC_I2C->CONSET = I2CONSET_STO;      /* Set Stop flag */
-		I2CMasterState = I2C_OK;
-	  }
-	}
+	I2CWriteNext();
 	LPC_I2C->CONCLR = I2CONCLR_SIC;
 	break;
 
 	case 0x30:
 	LPC_I2C->CONSET = I2CONSET_STO;      /* Set Stop flag */
-	I2CMasterState = I2C_NACK_ON_DATA;
+	I2CFinish( I2C_NACK_ON_DATA );
 	LPC_I2C->CONCLR = I2CONCLR_SIC;
 	break;
 	
 	case 0x40:	/* Master Receive, SLA_R has been sent */
-	if ( (RdIndex + 1) < I2CReadLength )
+	if ( (RdIndex + 1) < t->ReadLength )
 	{
 	  /* Will go to State 0x50 */
 	  LPC_I2C->CONSET = I2CONSET_AA;	/* assert ACK after data is received */
@@ -137,8 +323,9 @@ void I2C_IRQHandler(void)
 	break;
 	
 	case 0x50:	/* Data byte has been received, regardless following ACK or NACK */
-	I2CSlaveBuffer[RdIndex++] = LPC_I2C->DAT;
-	if ( (RdIndex + 1) < I2CReadLength )
+	t->ReadData[RdIndex++] = LPC_I2C->DAT;
+	I2CByteCount++;
+	if ( (RdIndex + 1) < t->ReadLength )
 	{   
 	  LPC_I2C->CONSET = I2CONSET_AA;	/* assert ACK after data is received */
 	}
@@ -150,29 +337,76 @@ void I2C_IRQHandler(void)
 	break;
 	
 	case 0x58:
-	I2CSlaveBuffer[RdIndex++] = LPC_I2C->DAT;
-	I2CMasterState = I2C_OK;
+	t->ReadData[RdIndex++] = LPC_I2C->DAT;
+	I2CByteCount++;
 	LPC_I2C->CONSET = I2CONSET_STO;	/* Set Stop flag */ 
+	I2CFinish( I2C_OK );
 	LPC_I2C->CONCLR = I2CONCLR_SIC;	/* Clear SI flag */
 	break;
 
 	case 0x20:		/* regardless, it's a NACK */
 	case 0x48:
 	LPC_I2C->CONSET = I2CONSET_STO;      /* Set Stop flag */
-	I2CMasterState = I2C_NACK_ON_ADDRESS;
+	I2CFinish( I2C_NACK_ON_ADDRESS );
 	LPC_I2C->CONCLR = I2CONCLR_SIC;
 	break;
 	
-	case 0x38:		/* Arbitration lost, in this example, we don't
-					deal with multiple master situation */
+	case 0x38:		/* Arbitration lost to another master. STA
+					is set again by the next transaction. */
 	default:
-	I2CMasterState = I2C_ARBITRATION_LOST;
+	I2CFinish( I2C_ARBITRATION_LOST );
 	LPC_I2C->CONCLR = I2CONCLR_SIC;	
 	break;
   }
+#if WCET_MEASUREMENT
+  if ( (StatValue >> 3) < WCET_I2C_CODES )
+	WCET_Record(WCET_I2C + (StatValue >> 3), start);
+  else
+	WCET_Record(WCET_I2C_OTHER, start);
+#endif
   return;
 }
 
+/*****************************************************************************
+** Function name:		I2CSubmit
+**
+** Descriptions:		Queue a transaction. It is started at once if
+**				the bus is idle, otherwise when the ones ahead
+**				of it have finished. The caller must not touch
+**				the descriptor until its Status is no longer
+**				I2C_BUSY; the Callback, if any, is then called
+**				from the interrupt handler.
+**
+** parameters:			Pointer to the transaction descriptor
+** Returned value:		true or false, return false if the queue is
+**				full or the lengths are too long
+** 
+*****************************************************************************/
+uint32_t I2CSubmit( I2CTransaction *t )
+{
+  uint32_t retVal = 0;
+
+  if ( (t->WriteLength > BUFSIZE) || (t->ReadLength > BUFSIZE) )
+  {
+	return( 0 );
+  }
+  /* Only the I2C interrupt shares the queue, so only it is masked */
+  NVIC_DisableIRQ(I2C_IRQn);
+  if ( (I2CQueueHead - I2CQueueTail) < I2C_QUEUE_SIZE )
+  {
+	t->Status = I2C_BUSY;
+	I2CQueue[I2CQueueHead % I2C_QUEUE_SIZE] = t;
+	I2CQueueHead++;
+	if ( I2CCurrent == 0 )
+	{
+	  I2CStartNext();
+	}
+	retVal = 1;
+  }
+  NVIC_EnableIRQ(I2C_IRQn);
+  return( retVal );
+}
+
 /*****************************************************************************
 ** Function name:		I2CStart
 **
@@ -186,7 +420,7 @@ void I2C_IRQHandler(void)
 *****************************************************************************/
 uint32_t I2CStart( void )
 {
-  uint32_t timeout = 0;
+  uint32_t start = TickCount;
   uint32_t retVal = 0;
  
   /*--- Issue a start condition ---*/
@@ -200,12 +434,11 @@ uint32_t I2CStart( void )
 	  retVal = 1;
 	  break;	
 	}
-	if ( timeout >= MAX_TIMEOUT )
+	if ( (TickCount - start) > I2C_TIMEOUT_TICKS )
 	{
 	  retVal = 0;
 	  break;
 	}
-	timeout++;
   }
   return( retVal );
 }
@@ -213,36 +446,80 @@ uint32_t I2CStart( void )
 /*****************************************************************************
 ** Function name:		I2CStop
 **
-** Descriptions:		Set the I2C stop condition, if the routine
-**				never exit, it's a fatal bus error.
+** Descriptions:		Set the I2C stop condition, if it is never
+**				sent within the timeout, it's a fatal bus
+**				error.
 **
 ** parameters:			None
-** Returned value:		true or never return
+** Returned value:		true or false, return false if timed out
 ** 
 *****************************************************************************/
 uint32_t I2CStop( void )
 {
+  uint32_t start = TickCount;
+
   LPC_I2C->CONSET = I2CONSET_STO;      /* Set Stop flag */ 
   LPC_I2C->CONCLR = I2CONCLR_SIC;  /* Clear SI flag */ 
             
   /*--- Wait for STOP detected ---*/
-  while( LPC_I2C->CONSET & I2CONSET_STO );
+  while( LPC_I2C->CONSET & I2CONSET_STO )
+  {
+	if ( (TickCount - start) > I2C_TIMEOUT_TICKS )
+	{
+	  return 0;
+	}
+  }
   return 1;
 }
 
 /*****************************************************************************
-** Function name:		I2CInit
+** Function name:		I2CSetBitRate
 **
-** Descriptions:		Initialize I2C controller
+** Descriptions:		Set SCLH and SCLL for I2C_SPEED_HZ from the
+**				current I2C clock. The I2C block runs from
+**				the system clock, and SystemCoreClock already
+**				includes the AHB divider. The period is
+**				rounded up, so SCL is never faster than
+**				I2C_SPEED_HZ.
 **
-** parameters:			I2c mode is either MASTER or SLAVE
-** Returned value:		true or false, return false if the I2C
-**				interrupt handler was not installed correctly
+** parameters:			None
+** Returned value:		None
 ** 
 *****************************************************************************/
-uint32_t I2CInit( uint32_t I2cMode ) 
+static void I2CSetBitRate( void )
+{
+  uint32_t period = (SystemCoreClock + I2C_SPEED_HZ - 1) / I2C_SPEED_HZ;
+  uint32_t low = (period * I2C_SCLL_PERCENT + 99) / 100;
+  uint32_t high = period - low;
+
+  if ( low < I2C_SCL_MIN_COUNT )
+  {
+	low = I2C_SCL_MIN_COUNT;
+  }
+  if ( high < I2C_SCL_MIN_COUNT )
+  {
+	high = I2C_SCL_MIN_COUNT;
+  }
+  LPC_I2C->SCLL = low;
+  LPC_I2C->SCLH = high;
+}
+
+/*****************************************************************************
+** Function name:		I2CConfigure
+**
+** Descriptions:		Set up the I2C controller, its clock and its
+**				pins, and enable it. The NVIC is left alone,
+**				so that bus recovery can use this while the
+**				I2C interrupt is disabled.
+**
+** parameters:			I2c mode is MASTER, optionally ORed with
+**				SLAVE to answer at I2C_SLAVE_ADDR
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CConfigure( uint32_t I2cMode )
 {
-  LPC_SYSCON->PRESETCTRL |= (0x1<<1);
+  LPC_SYSCON->PRESETCTRL |= (0x1<<1);	/* Release controller from reset */
 
   LPC_SYSCON->SYSAHBCLKCTRL |= (1<<5);
   //LPC_IOCON->PIO0_4 &= ~0x3F;	/*  I2C I/O config */
@@ -260,65 +537,201 @@ uint32_t I2CInit( uint32_t I2cMode )
 
   /*--- Reset registers ---*/
 #if FAST_MODE_PLUS
-  LPC_IOCON->PIO0_4 |= (0x2<<8);
+  LPC_IOCON->PIO0_4 |= (0x2<<8);	/* Fast-mode Plus I/O */
   LPC_IOCON->PIO0_5 |= (0x2<<8);
-  LPC_I2C->SCLL   = I2SCLL_HS_SCLL;
-  LPC_I2C->SCLH   = I2SCLH_HS_SCLH;
-#else
-  LPC_I2C->SCLL   = I2SCLL_SCLL;
-  LPC_I2C->SCLH   = I2SCLH_SCLH;
 #endif
+  I2CSetBitRate();
 
-//  if ( I2cMode == I2CSLAVE )
-//  {
-//	LPC_I2C->ADR0 = PCF8594_ADDR;
-//  }
+  I2CMode = I2cMode;
+  if ( I2cMode & I2CSLAVE )
+  {
+	LPC_I2C->ADR0 = I2C_SLAVE_ADDR;
+  }
 
-  /* Enable the I2C Interrupt */
+  LPC_I2C->CONSET = I2CONSET_I2EN;
+  if ( I2cMode & I2CSLAVE )
+  {
+	LPC_I2C->CONSET = I2CONSET_AA;
+  }
+}
+
+/*****************************************************************************
+** Function name:		I2CInit
+**
+** Descriptions:		Initialize I2C controller
+**
+** parameters:			I2c mode is MASTER, optionally ORed with
+**				SLAVE to answer at I2C_SLAVE_ADDR
+** Returned value:		true or false, return false if the I2C
+**				interrupt handler was not installed correctly
+** 
+*****************************************************************************/
+uint32_t I2CInit( uint32_t I2cMode ) 
+{
+  /* Enable the I2C Interrupt, below the ADC and SysTick */
+  NVIC_SetPriority(I2C_IRQn, I2C_IRQ_PRIORITY);
   NVIC_EnableIRQ(I2C_IRQn);
 
-  LPC_I2C->CONSET = I2CONSET_I2EN;
+  I2CConfigure( I2cMode );
   return( 1 );
 }
 
+/*****************************************************************************
+** Function name:		I2CHalfBitDelay
+**
+** Descriptions:		Wait for about half of a 100 kHz SCL period
+**				while the bus is being driven as GPIO.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CHalfBitDelay( void )
+{
+  uint32_t i;
+
+  /* Assume that the loop takes 4 clocks */
+  for ( i = SystemCoreClock / 800000; i > 0; i-- )
+  {
+	__NOP();
+  }
+}
+
+/*****************************************************************************
+** Function name:		I2CRecoverBus
+**
+** Descriptions:		Free a bus that a slave is holding low. The
+**				pins are switched to GPIO and SCL is clocked
+**				until the slave releases SDA, then a stop
+**				condition is sent by hand. Finally the I2C
+**				controller itself is reset and set up again.
+**				The I2C interrupt must be disabled, and is
+**				left disabled.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+static void I2CRecoverBus( void )
+{
+  uint32_t i;
+
+  I2CBusRecoveries++;
+  LPC_I2C->CONCLR = I2CONCLR_I2ENC;
+
+  /*--- Drive the pins as GPIO, both are open drain ---*/
+  LPC_GPIO0->MASKED_ACCESS[I2C_SCL_PIN | I2C_SDA_PIN] = I2C_SCL_PIN | I2C_SDA_PIN;
+  LPC_GPIO0->DIR = (LPC_GPIO0->DIR | I2C_SCL_PIN) & ~I2C_SDA_PIN;
+  LPC_IOCON->PIO0_4 = 0x00;
+  LPC_IOCON->PIO0_5 = 0x00;
+
+  /*--- Clock SCL until the slave lets go of SDA ---*/
+  for ( i = 0; i < I2C_RECOVERY_CLOCKS; i++ )
+  {
+	if ( LPC_GPIO0->MASKED_ACCESS[I2C_SDA_PIN] )
+	{
+	  break;
+	}
+	LPC_GPIO0->MASKED_ACCESS[I2C_SCL_PIN] = 0;
+	I2CHalfBitDelay();
+	LPC_GPIO0->MASKED_ACCESS[I2C_SCL_PIN] = I2C_SCL_PIN;
+	I2CHalfBitDelay();
+  }
+
+  /*--- Stop condition: SDA rises while SCL is high ---*/
+  LPC_GPIO0->MASKED_ACCESS[I2C_SCL_PIN] = 0;
+  LPC_GPIO0->MASKED_ACCESS[I2C_SDA_PIN] = 0;
+  LPC_GPIO0->DIR |= I2C_SDA_PIN;
+  I2CHalfBitDelay();
+  LPC_GPIO0->MASKED_ACCESS[I2C_SCL_PIN] = I2C_SCL_PIN;
+  I2CHalfBitDelay();
+  LPC_GPIO0->MASKED_ACCESS[I2C_SDA_PIN] = I2C_SDA_PIN;
+  I2CHalfBitDelay();
+  LPC_GPIO0->DIR &= ~(I2C_SCL_PIN | I2C_SDA_PIN);
+
+  /*--- Reset the controller and give the pins back to it ---*/
+  LPC_SYSCON->PRESETCTRL &= ~(0x1<<1);
+  I2CConfigure( I2CMode );
+}
+
+/*****************************************************************************
+** Function name:		I2CCheckTimeout
+**
+** Descriptions:		Abandon the current transaction if it has
+**				taken longer than I2C_TIMEOUT_MS, recover the
+**				bus, and start the next transaction. Must be
+**				called regularly from the main loop, never
+**				from an interrupt handler.
+**
+** parameters:			None
+** Returned value:		true or false, return false if the current
+**				transaction timed out
+** 
+*****************************************************************************/
+uint32_t I2CCheckTimeout( void )
+{
+  uint32_t retVal = 1;
+
+  NVIC_DisableIRQ(I2C_IRQn);
+  if ( (I2CCurrent != 0) && ((TickCount - I2CStartTick) > I2C_TIMEOUT_TICKS) )
+  {
+	I2CRecoverBus();
+	I2CFinish( I2C_TIME_OUT );
+	retVal = 0;
+  }
+  NVIC_EnableIRQ(I2C_IRQn);
+  return( retVal );
+}
+
 /*****************************************************************************
 ** Function name:		I2CEngine
 **
 ** Descriptions:		The routine to complete a I2C transaction
-**				from start to stop. All the intermitten
-**				steps are handled in the interrupt handler.
+**				from start to stop, waiting until it is done.
 **				Before this routine is called, the read
-**				length, write length, I2C master buffer,
-**				and I2C command fields need to be filled.
-**				see i2cmst.c for more details. 
+**				length, write length and I2C master buffer
+**				need to be filled. I2CMasterBuffer[0] is the
+**				slave address and I2CWriteLength counts it
+**				as well as the data bytes that follow. The
+**				bytes read are left in I2CSlaveBuffer.
 **
 ** parameters:			None
-** Returned value:		true or false, return false only if the
-**				start condition can never be generated and
-**				timed out. 
+** Returned value:		Final state of the transaction, I2C_OK or
+**				one of the error states. Any transaction
+**				ahead of this one in the queue is finished
+**				first, so this must only be called from the
+**				main loop.
 ** 
 *****************************************************************************/
 uint32_t I2CEngine( void ) 
 {
-  RdIndex = 0;
-  WrIndex = 0;
+  static I2CTransaction t;
+  uint32_t i;
 
-  /*--- Issue a start condition ---*/
-  LPC_I2C->CONSET = I2CONSET_STA;	/* Set Start flag */
+  t.Address = I2CMasterBuffer[0] & ~RD_BIT;
+  t.WriteLength = (I2CWriteLength > 1) ? I2CWriteLength - 1 : 0;
+  t.ReadLength = I2CReadLength;
+  t.Callback = 0;
+  for ( i = 0; i < t.WriteLength; i++ )
+  {
+	t.WriteData[i] = I2CMasterBuffer[i + 1];
+  }
 
-  I2CMasterState = I2C_BUSY;	
+  I2CMasterState = I2C_BUSY;
+  if ( !I2CSubmit( &t ) )
+  {
+	return ( I2C_BUSY );
+  }
 
-  while ( I2CMasterState == I2C_BUSY )
+  while ( t.Status == I2C_BUSY )
   {
-	if ( timeout >= MAX_TIMEOUT )
-	{
-	  I2CMasterState = I2C_TIME_OUT;
-	  break;
-	}
-	timeout++;
+	I2CCheckTimeout();
   }
-  LPC_I2C->CONCLR = I2CONCLR_STAC;
 
+  for ( i = 0; i < t.ReadLength; i++ )
+  {
+	I2CSlaveBuffer[i] = t.ReadData[i];
+  }
   return ( I2CMasterState );
 }
 
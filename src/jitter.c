@@ -0,0 +1,198 @@
+/**
+ * @file jitter.c
+ *
+ * @brief Measures the latency distribution of the charger's interrupts.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T10:02:17-0400
+ * @date Last modified: 2026-10-19T10:02:17-0400
+ *
+ * @details Each measured handler calls its Jitter_ function on entry. The
+ * latency is found differently for each interrupt:
+ *   - SysTick: the SysTick counter reloads at the moment the interrupt is
+ *     requested, so the number of cycles it has counted down since the reload
+ *     is exactly the latency.
+ *   - ADC: in burst mode the conversions arrive at a fixed period. The
+ *     difference between the measured spacing of two ADC interrupts and that
+ *     period is the change in latency from one interrupt to the next.
+ *   - I2C: while receiving, successive data bytes complete nine SCL periods
+ *     apart. The difference between the measured spacing and nine SCL periods
+ *     is recorded in the same way. The controller stretches SCL until the
+ *     previous handler clears SI, so this also includes the time the bus was
+ *     held up by that handler.
+ *
+ * The results are left in the ::Jitter array, where they can be read with the
+ * debugger while the charger is running under full load.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "jitter.h"
+
+#if JITTER_MEASUREMENT
+//
+// The ADC needs 11 clocks for each channel converted in burst mode
+//
+static const uint32_t ADC_CLOCKS_PER_CONVERSION = 11;
+//
+// An I2C byte plus its acknowledge bit
+//
+static const uint32_t I2C_BITS_PER_BYTE = 9;
+//
+// Timer used as a free-running cycle counter
+//
+#  define CYCLE_TIMER         LPC_TMR32B0
+static const uint32_t SYSCON_SYSAHBCLKCTRL_CT32B0 = 1uL << 9;
+static const uint32_t TIMER_TCR_ENABLE = 1uL << 0;
+static const uint32_t TIMER_TCR_RESET  = 1uL << 1;
+
+/**
+ * @var Jitter
+ * @brief The latency distribution for each measured interrupt.
+ */
+volatile JitterStats_t Jitter[JITTER_NUM_SOURCES];
+
+/**
+ * @var ADC_Period
+ * @brief Nominal cycles between ADC interrupts.
+ * @var I2C_ByteTime
+ * @brief Nominal cycles to transfer one I2C byte.
+ * @var ADC_Last
+ * @brief Cycle counter at the previous ADC interrupt.
+ * @var I2C_Last
+ * @brief Cycle counter at the previous I2C interrupt.
+ * @var I2C_LastStatus
+ * @brief I2C status code at the previous I2C interrupt.
+ */
+static uint32_t ADC_Period, I2C_ByteTime;
+static uint32_t ADC_Last, I2C_Last, I2C_LastStatus;
+
+/**
+ * @brief Add one latency value to the distribution for an interrupt.
+ *
+ * @param[in] source one of the JITTER_ index values
+ * @param[in] cycles the latency, in system clock cycles
+ */
+static void Record(uint32_t source, uint32_t cycles)
+{
+  volatile JitterStats_t *stats = &Jitter[source];
+  uint32_t bucket = 0;
+  uint32_t scaled = cycles >> 4;
+
+  while ((scaled != 0) && (bucket < (JITTER_BUCKETS - 1))) {
+    scaled >>= 1;
+    bucket++;
+  }
+  stats->Bucket[bucket]++;
+  if ((0 == stats->Count) || (cycles < stats->Min))
+    stats->Min = cycles;
+  if (cycles > stats->Max)
+    stats->Max = cycles;
+  stats->Count++;
+}
+
+/**
+ * @brief Record how far a measured spacing differs from its nominal value.
+ *
+ * @param[in] source one of the JITTER_ index values
+ * @param[in] spacing the measured time between two interrupts
+ * @param[in] nominal the expected time between two interrupts
+ */
+static void RecordSpacing(uint32_t source, uint32_t spacing, uint32_t nominal)
+{
+  if (spacing > nominal)
+    Record(source, spacing - nominal);
+  else
+    Record(source, nominal - spacing);
+}
+
+/**
+ * @brief Clear all statistics and start the cycle counter.
+ * @details The nominal ADC period and I2C byte time are found from the
+ * registers that were set up by ADC_Init() and I2CInit(), so this must be
+ * called after both of those. The cycle counter runs from the same
+ * peripheral clock as the ADC and I2C so no scaling is needed.
+ */
+void Jitter_Init(void)
+{
+  uint32_t source, bucket, channels;
+
+  for (source = 0; source < JITTER_NUM_SOURCES; source++) {
+    Jitter[source].Count = 0;
+    Jitter[source].Min = 0;
+    Jitter[source].Max = 0;
+    for (bucket = 0; bucket < JITTER_BUCKETS; bucket++)
+      Jitter[source].Bucket[bucket] = 0;
+  }
+
+  channels = 0;
+  for (source = 0; source < 8; source++) {
+    if (LPC_ADC->CR & (1uL << source))
+      channels++;
+  }
+  ADC_Period = ADC_CLOCKS_PER_CONVERSION * channels *
+      (((LPC_ADC->CR >> 8) & 0xFF) + 1);
+  I2C_ByteTime = I2C_BITS_PER_BYTE * (LPC_I2C->SCLH + LPC_I2C->SCLL);
+  I2C_LastStatus = 0;
+
+  LPC_SYSCON->SYSAHBCLKCTRL |= SYSCON_SYSAHBCLKCTRL_CT32B0;
+  CYCLE_TIMER->TCR = TIMER_TCR_RESET;
+  CYCLE_TIMER->PR = 0;
+  CYCLE_TIMER->MCR = 0;
+  CYCLE_TIMER->TCR = TIMER_TCR_ENABLE;
+  ADC_Last = I2C_Last = CYCLE_TIMER->TC;
+}
+
+/**
+ * @brief Measure the SysTick interrupt latency.
+ */
+void Jitter_SysTick(void)
+{
+  Record(JITTER_SYSTICK, SysTick->LOAD - SysTick->VAL);
+}
+
+/**
+ * @brief Measure the variation in ADC interrupt latency.
+ * @details The first interrupt after reset has nothing to compare with, and
+ * a spacing of more than twice the nominal period means that an interrupt was
+ * missed entirely, so neither of these is recorded.
+ */
+void Jitter_ADC(void)
+{
+  uint32_t now = CYCLE_TIMER->TC;
+  uint32_t spacing = now - ADC_Last;
+
+  ADC_Last = now;
+  if (spacing < 2 * ADC_Period)
+    RecordSpacing(JITTER_ADC, spacing, ADC_Period);
+}
+
+/**
+ * @brief Measure the variation in I2C interrupt latency.
+ * @details Only the data-received states are measured, because those are the
+ * only ones where the time since the previous interrupt is exactly one byte.
+ *
+ * @param[in] status the I2C status code for this interrupt
+ */
+void Jitter_I2C(uint32_t status)
+{
+  uint32_t now = CYCLE_TIMER->TC;
+
+  if (((0x50 == status) || (0x58 == status)) &&
+      ((0x40 == I2C_LastStatus) || (0x50 == I2C_LastStatus)))
+    RecordSpacing(JITTER_I2C, now - I2C_Last, I2C_ByteTime);
+  I2C_Last = now;
+  I2C_LastStatus = status;
+}
+#endif
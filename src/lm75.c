@@ -0,0 +1,251 @@
+/**
+ * @file lm75.c
+ *
+ * @brief Reads, decodes and filters the LM75 temperature sensor.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T14:05:22-0400
+ * @date Last modified: 2026-10-20T13:18:44-0400
+ *
+ * @details At startup LM75_Init() tries to read every address that an LM75
+ * can use, and each sensor that answers is added to ::LM75Sensors. After that
+ * the main loop calls LM75_Poll() continuously, and every ::TEMP_READ_TICKS it
+ * starts a non-blocking read of the next sensor's two-byte temperature
+ * register, in round-robin order. When the read completes the two bytes are
+ * decoded to a signed fixed-point temperature and posted to ::SensorEvents,
+ * with the sensor number added to the event type. The SysTick handler then
+ * passes each reading through LM75_Filter(), which keeps the filtered
+ * temperature of each sensor in ::LM75Sensors.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "SysTick.h"
+#include "charger.h"
+#include "i2c.h"
+#include "queue.h"
+#include "wdt.h"
+#include "lm75.h"
+
+//
+// Valid bits in the 16-bit temperature register
+//
+#if LM75B_MODE
+static const uint32_t LM75_TEMP_Msk = 0xFFE0;
+#else
+static const uint32_t LM75_TEMP_Msk = 0xFF80;
+#endif
+
+#if (EVENT_TEMPERATURE + LM75_MAX_SENSORS - 1) > EVENT_TEMPERATURE_LAST
+#  error "Not enough temperature event types for LM75_MAX_SENSORS"
+#endif
+
+/**
+ * @var LM75Sensors
+ * @brief The registry of sensors found by LM75_Init(), and their readings.
+ * @var LM75SensorCount
+ * @brief The number of valid entries in ::LM75Sensors.
+ * @var LM75BatterySensor
+ * @brief The index in ::LM75Sensors of the sensor on the battery.
+ */
+volatile LM75Sensor_t LM75Sensors[LM75_MAX_SENSORS];
+uint32_t LM75SensorCount;
+uint32_t LM75BatterySensor;
+
+/**
+ * @var TemperatureRead
+ * @brief The I2C transaction that reads a sensor.
+ * @var ReadSensor
+ * @brief The index of the sensor that TemperatureRead is reading.
+ * @var LastReadTick
+ * @brief The value of ::TickCount when the last read was started.
+ */
+static I2CTransaction TemperatureRead;
+static uint32_t ReadSensor;
+static uint32_t LastReadTick;
+
+/**
+ * @brief Called when a sensor read finishes.
+ * @details The temperature is passed on to the control loop only if the
+ * transaction succeeded, otherwise the sensor's error count is incremented.
+ *
+ * @param[in] t the completed transaction
+ */
+static void ReadDone(I2CTransaction *t)
+{
+  if (I2C_OK == t->Status) {
+    LM75Sensors[ReadSensor].LastReadTick = TickCount;
+    Queue_Put(&SensorEvents, EVENT_TEMPERATURE + ReadSensor,
+              LM75_Decode(t->ReadData[0], t->ReadData[1]));
+  } else
+    LM75Sensors[ReadSensor].Errors++;
+}
+
+/**
+ * @brief Find the sensors on the bus and set up the transaction that reads
+ * them.
+ * @details Each possible address is read once, waiting for the transaction
+ * to finish. A sensor that does not answer ends its read with a NACK, or at
+ * worst a timeout, so the whole scan takes no more than ::LM75_MAX_SENSORS
+ * times ::I2C_TIMEOUT_MS. After power-up the LM75 register pointer selects
+ * the temperature register, so each read is just two bytes with no register
+ * address.
+ *
+ * @return the number of sensors found
+ */
+uint32_t LM75_Init(void)
+{
+  uint32_t sensor;
+
+  LM75SensorCount = 0;
+  LM75BatterySensor = 0;
+  TemperatureRead.WriteLength = 0;
+  TemperatureRead.ReadLength = 2;
+  TemperatureRead.Callback = 0;
+  for (sensor = 0; sensor < LM75_MAX_SENSORS; sensor++) {
+    TemperatureRead.Address = LM75_BASE_ADDR + 2 * sensor;
+    if (!I2CSubmit(&TemperatureRead))
+      continue;
+    while (I2C_BUSY == TemperatureRead.Status) {
+      WDT_CheckIn(WDT_TASK_MAIN);
+      I2CCheckTimeout();
+    }
+    if (I2C_OK == TemperatureRead.Status) {
+      if (LM75_BATTERY_ADDR == TemperatureRead.Address)
+        LM75BatterySensor = LM75SensorCount;
+      LM75Sensors[LM75SensorCount].Address = TemperatureRead.Address;
+      LM75Sensors[LM75SensorCount].Valid = 0;
+      LM75Sensors[LM75SensorCount].Errors = 0;
+      LM75Sensors[LM75SensorCount].LastReadTick = TickCount;
+      LM75Sensors[LM75SensorCount].Lost = 0;
+      LM75SensorCount++;
+    }
+  }
+  TemperatureRead.Callback = ReadDone;
+  ReadSensor = LM75SensorCount - 1;
+  LastReadTick = TickCount - TEMP_READ_TICKS;
+  return LM75SensorCount;
+}
+
+/**
+ * @brief Start the next sensor read if one is due.
+ * @details A new read is not started while the previous one is still in
+ * progress. This never waits for the bus.
+ */
+void LM75_Poll(void)
+{
+  if ((0 != LM75SensorCount) &&
+      ((TickCount - LastReadTick) >= TEMP_READ_TICKS) &&
+      (I2C_BUSY != TemperatureRead.Status)) {
+    LastReadTick = TickCount;
+    if (++ReadSensor >= LM75SensorCount)
+      ReadSensor = 0;
+    TemperatureRead.Address = LM75Sensors[ReadSensor].Address;
+    I2CSubmit(&TemperatureRead);
+  }
+}
+
+/**
+ * @brief Convert the sensor register to a temperature.
+ * @details The register is a left-justified two's complement value, so once
+ * the unused low bits are cleared it is already the temperature in units of
+ * 1/256 degree C.
+ *
+ * @param[in] msb the first byte read from the sensor
+ * @param[in] lsb the second byte read from the sensor
+ * @return temperature, with ::TEMP_FRAC_BITS fractional bits
+ */
+int32_t LM75_Decode(uint8_t msb, uint8_t lsb)
+{
+  return (int16_t) ((((uint32_t) msb << 8) | lsb) & LM75_TEMP_Msk);
+}
+
+/**
+ * @brief Moving-average filter for the readings of one sensor.
+ * @details The output is the mean of the last ::TEMP_SAMPLES_TO_AVERAGE
+ * readings. Each new reading replaces the oldest one in the window, and the
+ * running sum is corrected by the difference. The first reading fills the
+ * whole window, so that the displayed temperature does not have to climb up
+ * from zero after reset, or after the sensor was lost. This must only be
+ * called from one place, the SysTick handler.
+ *
+ * @param[in] sensor index of the sensor in ::LM75Sensors
+ * @param[in] reading a new temperature, from LM75_Decode()
+ * @return the filtered temperature, with ::TEMP_FRAC_BITS fractional bits
+ */
+int32_t LM75_Filter(uint32_t sensor, int32_t reading)
+{
+  volatile LM75Sensor_t *s = &LM75Sensors[sensor];
+  uint32_t i;
+
+  if (!s->Valid) {
+    for (i = 0; i < TEMP_SAMPLES_TO_AVERAGE; i++)
+      s->Samples[i] = reading;
+    s->Next = 0;
+    s->FilterSum = reading * TEMP_SAMPLES_TO_AVERAGE;
+    s->Valid = 1;
+    s->Lost = 0;
+  } else {
+    s->FilterSum += reading - s->Samples[s->Next];
+    s->Samples[s->Next] = reading;
+    if (++s->Next >= TEMP_SAMPLES_TO_AVERAGE)
+      s->Next = 0;
+  }
+  s->Temperature = s->FilterSum / TEMP_SAMPLES_TO_AVERAGE;
+  return s->Temperature;
+}
+
+/**
+ * @brief Mark the sensors that have stopped answering as lost.
+ * @details Each sensor is read once every ::TEMP_READ_TICKS times the number
+ * of sensors. A sensor with no good read in ::TEMP_MISSED_READS of those
+ * intervals is marked lost, and its filtered temperature is no longer valid.
+ * Its next good reading restarts the filter. This must only be called from
+ * the SysTick handler.
+ */
+void LM75_Expire(void)
+{
+  uint32_t sensor;
+  uint32_t limit = TEMP_MISSED_READS * TEMP_READ_TICKS * LM75SensorCount;
+  volatile LM75Sensor_t *s;
+
+  for (sensor = 0; sensor < LM75SensorCount; sensor++) {
+    s = &LM75Sensors[sensor];
+    if ((TickCount - s->LastReadTick) > limit) {
+      s->Valid = 0;
+      s->Lost = 1;
+    }
+  }
+}
+
+/**
+ * @brief Find the hottest sensor.
+ * @details Sensors that have not yet been read, or have been lost, are
+ * ignored.
+ *
+ * @return the highest filtered temperature, or ::TEMP_NONE if no sensor has
+ * been read
+ */
+int32_t LM75_Hottest(void)
+{
+  uint32_t sensor;
+  int32_t hottest = TEMP_NONE;
+
+  for (sensor = 0; sensor < LM75SensorCount; sensor++) {
+    if (LM75Sensors[sensor].Valid &&
+        (LM75Sensors[sensor].Temperature > hottest))
+      hottest = LM75Sensors[sensor].Temperature;
+  }
+  return hottest;
+}
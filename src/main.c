@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-08T19:12:48-0500
- * @date Last modified: 2014-01-12T17:45:06-0500
+ * @date Last modified: 2026-10-20T13:18:44-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -27,12 +27,23 @@
 #include "LCD.h"
 #include "SysTick.h"
 #include "i2c.h"
+#include "wdt.h"
+#include "jitter.h"
+#include "queue.h"
+#include "stack.h"
+#include "wcet.h"
+#include "lm75.h"
+#include "regmap.h"
+#include "uart.h"
+#include "telemetry.h"
 
 /**
  * @var State
  * @brief The current operating state of the charger.
+ * @var Fault
+ * @brief The reason for the ERROR state, one of ::ChargerFault.
  */
-uint32_t State;
+volatile uint32_t State, Fault;
 
 /**
  * @var FastVoltage
@@ -42,13 +53,25 @@ uint32_t State;
  * @var RawCurrent
  * @brief The accumulator for the long moving-average filter of currents.
  */
-uint32_t FastVoltage, RawCurrent, RawVoltage;
+volatile uint32_t FastVoltage, RawCurrent, RawVoltage;
 
 /**
  * @var Temperature
- * @brief The most recent temperature reading from the sensor.
+ * @brief The filtered temperature from the battery sensor, in degrees C with
+ * ::TEMP_FRAC_BITS fractional bits, or ::TEMP_NONE if there is no reading.
+ * @var HottestTemperature
+ * @brief The highest filtered temperature from any sensor, in the same
+ * units, or ::TEMP_NONE.
+ * @details These are only written by the SysTick handler, which takes new
+ * readings from ::SensorEvents.
  */
-uint32_t Temperature;
+volatile int32_t Temperature = TEMP_NONE, HottestTemperature = TEMP_NONE;
+
+/**
+ * @var SensorEvents
+ * @brief Sensor readings from the I2C interrupt to the SysTick control loop.
+ */
+EventQueue_t SensorEvents;
 
 /**
  * @brief The main function for the charger.
@@ -58,8 +81,10 @@ uint32_t Temperature;
 int main()
 {
   uint32_t i;
+  const char *msg;
 
   FastVoltage = RawVoltage = RawCurrent = 0;
+  Queue_Init(&SensorEvents);
 
   PWM_Stop();                   // Disable PWM output (set it low)
   ADC_Init();                   // Initialize the A/D converters
@@ -74,7 +99,21 @@ int main()
   //
   for (i = 0; i < (SystemCoreClock / 32); i++) {
   }
+#if !LCD_I2C_BACKPACK
   LCD_Init();
+#endif
+  //
+  // Start the watchdog. If the last reset was caused by a task missing its
+  // deadline, halt in the ERROR state.
+  //
+  WDT_Init();
+  if (WDT_TASK_NONE != WDT_LastFailure()) {
+    State = ERROR;
+    Fault = FAULT_WATCHDOG;
+  }
+#if TELEMETRY_ENABLE
+  UART_Init();
+#endif
   //
   // Set up the System Tick
   //
@@ -82,24 +121,54 @@ int main()
   FLAG1_PORT->DATA &= ~FLAG1_Msk;
   Ticks = 0;
   SysTick_Config((SystemCoreClock / TICKS_PER_SEC) - 1);
+  NVIC_SetPriority(SysTick_IRQn, SYSTICK_IRQ_PRIORITY);
   //
-  // Set up the I2C interface for the temperature sensor
+  // Set up the I2C interface and find the temperature sensors. The scan
+  // needs the SysTick running for its timeouts.
   //
+#if I2C_SLAVE_ENABLE
+  RegMap_Init();
+  I2CInit((uint32_t) (I2CMASTER | I2CSLAVE));
+#else
   I2CInit((uint32_t) I2CMASTER);
+#endif
+  //
+  // An LCD on the I2C bus can only be set up now. Until then the SysTick
+  // handler only changes the display text.
+  //
+#if LCD_I2C_BACKPACK
+  LCD_Init();
+#endif
+  //
+  // Show which task failed if the watchdog caused the last reset
+  //
+  if (FAULT_WATCHDOG == Fault) {
+    msg = WDT_FailureMessage(WDT_LastFailure());
+    for (i = 0; (i <= MAX_COL) && (msg[i] != '\0'); i++)
+      BottomLine[i] = msg[i];
+    for (; i <= MAX_COL; i++)
+      BottomLine[i] = ' ';
+  }
+  LM75_Init();
+#if JITTER_MEASUREMENT
+  Jitter_Init();
+#endif
+#if WCET_MEASUREMENT
+  WCET_Init();
+#endif
 
   for (;;) {
+    WDT_CheckIn(WDT_TASK_MAIN);
+    I2CCheckTimeout();
+    LM75_Poll();
+    LCD_Poll();
     if (0 == Ticks) {
-      for (i = 0; i < BUFSIZE; i++) {
-        I2CSlaveBuffer[i] = 0x00;
-      }
-      I2CWriteLength = 0;
-      I2CReadLength = 2;
-      I2CMasterBuffer[0] = LM75_ADDR | RD_BIT;
-      I2CEngine();
-
-      Temperature = I2CSlaveBuffer[0];
-      // Wait until Ticks becomes non-zero to read the sensor again
+      StackPeak = Stack_HighWater();
+      // Wait until Ticks becomes non-zero to check the stack again
       while (0 == Ticks) {
+        WDT_CheckIn(WDT_TASK_MAIN);
+        I2CCheckTimeout();
+        LCD_Poll();
       }
     }
   }
@@ -5,7 +5,7 @@
  *
  * @author K. Joseph Hass
  * @date Created: 2014-01-02T16:16:18-0500
- * @date Last modified: 2014-01-13T08:36:54-0500
+ * @date Last modified: 2026-10-19T23:57:31-0400
  *
  * @copyright Copyright (C) 2014 Kenneth Joseph Hass
  *
@@ -43,6 +43,11 @@ static uint32_t PWM_UpValue;
  * at each SysTick if we want to decrease the duty cycle.
  */
 static uint32_t PWM_DownValue;
+/**
+ * 2^24 / PWM_Period, so that the high time times this value, shifted right
+ * by 8 bits, is the duty cycle in units of 1/65536 without dividing.
+ */
+static uint32_t PWM_DutyScale;
 
 /**
  * @brief Configure and initialize the PWM output.
@@ -99,6 +104,7 @@ void PWM_Start()
   if (PWM_UpValue == 0) PWM_UpValue = 1;
   PWM_DownValue = PWM_Period >> PWM_DOWN_STEP;
   if (PWM_DownValue == 0) PWM_DownValue = 1;
+  PWM_DutyScale = (1uL << 24) / PWM_Period;
 }
 /**
  * @brief Stop and disable the PWM signal.
@@ -142,3 +148,17 @@ void PWM_DecreaseDutyCycle()
     PWM_LowTime += PWM_DownValue;
   PWM_TIMER->MR0 = PWM_LowTime;
 }
+/**
+ * @brief Find the present PWM duty cycle.
+ * @details The high time is scaled by ::PWM_DutyScale rather than divided by
+ * the period, so this takes the same few cycles for any duty cycle. It
+ * returns 0 before PWM_Start() has been called.
+ *
+ * @return the duty cycle in units of 1/65536, at most 65535
+ */
+uint32_t PWM_Duty()
+{
+  uint32_t duty = ((PWM_Period - PWM_LowTime) * PWM_DutyScale) >> 8;
+
+  return (duty > 0xFFFF) ? 0xFFFF : duty;
+}
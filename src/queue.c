@@ -0,0 +1,97 @@
+/**
+ * @file queue.c
+ *
+ * @brief Lock-free single-producer, single-consumer event queue.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T10:41:05-0400
+ * @date Last modified: 2026-10-19T10:41:05-0400
+ *
+ * @details One context (an interrupt handler or the main loop) puts events
+ * into a queue and exactly one other context takes them out. Since each
+ * index is written by only one side, and a 32-bit store is atomic on the
+ * Cortex-M0, no interrupts need to be disabled. The event is always written
+ * into the buffer before the head index that makes it visible, and it is
+ * always read out before the tail index that releases its slot.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "queue.h"
+
+static const uint32_t QUEUE_INDEX_Msk = QUEUE_SIZE - 1;
+
+/**
+ * @brief Empty a queue.
+ * @details This must not be called while either side may be using the
+ * queue.
+ *
+ * @param[out] queue the queue
+ */
+void Queue_Init(EventQueue_t *queue)
+{
+  queue->Head = 0;
+  queue->Tail = 0;
+  queue->Dropped = 0;
+}
+
+/**
+ * @brief Add an event to a queue.
+ * @details Must only be called by the producer. If the queue is full the
+ * event is discarded and counted, the producer never waits.
+ *
+ * @param[in,out] queue the queue
+ * @param[in] type the event type, one of the EVENT_ values
+ * @param[in] value the data for the event
+ * @return 1 if the event was added, 0 if the queue was full
+ */
+uint32_t Queue_Put(EventQueue_t *queue, uint32_t type, int32_t value)
+{
+  uint32_t head = queue->Head;
+  volatile Event_t *slot;
+
+  if ((head - queue->Tail) >= QUEUE_SIZE) {
+    queue->Dropped++;
+    return 0;
+  }
+  slot = &queue->Event[head & QUEUE_INDEX_Msk];
+  slot->Type = type;
+  slot->Value = value;
+  __DMB();
+  queue->Head = head + 1;
+  return 1;
+}
+
+/**
+ * @brief Remove the oldest event from a queue.
+ * @details Must only be called by the consumer.
+ *
+ * @param[in,out] queue the queue
+ * @param[out] event the event that was removed
+ * @return 1 if an event was removed, 0 if the queue was empty
+ */
+uint32_t Queue_Get(EventQueue_t *queue, Event_t *event)
+{
+  uint32_t tail = queue->Tail;
+  volatile Event_t *slot;
+
+  if (tail == queue->Head)
+    return 0;
+  slot = &queue->Event[tail & QUEUE_INDEX_Msk];
+  event->Type = slot->Type;
+  event->Value = slot->Value;
+  __DMB();
+  queue->Tail = tail + 1;
+  return 1;
+}
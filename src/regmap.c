@@ -0,0 +1,127 @@
+/**
+ * @file regmap.c
+ *
+ * @brief Publishes charger status for an external supervisor on the I2C bus.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T16:14:37-0400
+ * @date Last modified: 2026-10-19T16:14:37-0400
+ *
+ * @details The SysTick handler writes a complete ::RegMap_t snapshot every
+ * tick, and the I2C handler sends bytes straight out of the newest snapshot
+ * when the supervisor reads. Nothing is copied while a read is in progress,
+ * and the supervisor never sees a snapshot that is only partly written.
+ *
+ * There are three snapshot buffers. One is the newest complete snapshot, one
+ * may be held by a read in progress, and the SysTick handler always writes
+ * into one that is neither. The SysTick handler can interrupt the I2C
+ * handler, but not the other way around, so the SysTick handler always sees
+ * a consistent pair of ::Published and ::Reading values. The I2C handler
+ * can only take the buffer that was published when it started, and that
+ * buffer is not written again until a later tick has published another one.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "regmap.h"
+
+//
+// Number of snapshot buffers, and the value of Reading when none is held
+//
+#define NUM_SNAPSHOTS  3
+static const uint32_t SNAPSHOT_NONE = NUM_SNAPSHOTS;
+
+/**
+ * @var Snapshot
+ * @brief The snapshot buffers.
+ * @var Published
+ * @brief Index of the newest complete snapshot.
+ * @var Reading
+ * @brief Index of the snapshot held by a read, or ::SNAPSHOT_NONE.
+ * @var Sequence
+ * @brief Count of snapshots published.
+ */
+static RegMap_t Snapshot[NUM_SNAPSHOTS];
+static volatile uint32_t Published;
+static volatile uint32_t Reading;
+static uint8_t Sequence;
+
+/**
+ * @brief Set up the snapshot buffers.
+ */
+void RegMap_Init(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < NUM_SNAPSHOTS; i++)
+    Snapshot[i].Version = REGMAP_VERSION;
+  Published = 0;
+  Reading = SNAPSHOT_NONE;
+}
+
+/**
+ * @brief Write a new snapshot and make it the one that the supervisor reads.
+ * @details This must only be called from the SysTick handler.
+ *
+ * @param[in] voltage_mV the battery voltage
+ * @param[in] current_mA the charging current
+ * @param[in] charge_mAh the charge delivered since reset
+ */
+void RegMap_Update(uint32_t voltage_mV, uint32_t current_mA,
+                   uint32_t charge_mAh)
+{
+  uint32_t next;
+  RegMap_t *s;
+
+  //
+  // Find a buffer that is neither the newest nor being read
+  //
+  for (next = 0; (next == Published) || (next == Reading); next++) {
+  }
+  s = &Snapshot[next];
+  s->State = State;
+  s->Fault = Fault;
+  s->Sequence = ++Sequence;
+  s->Voltage_mV = voltage_mV;
+  s->Current_mA = current_mA;
+  s->Temperature = Temperature;
+  s->HottestTemperature = HottestTemperature;
+  s->Charge_mAh = charge_mAh;
+  __DMB();
+  Published = next;
+}
+
+/**
+ * @brief Hold the newest snapshot until RegMap_Release() is called.
+ * @details This must only be called from the I2C handler, when the
+ * supervisor starts a read.
+ *
+ * @return pointer to the first byte of the snapshot, ::REGMAP_SIZE long
+ */
+const uint8_t *RegMap_Acquire(void)
+{
+  uint32_t newest = Published;
+
+  Reading = newest;
+  return (const uint8_t *) &Snapshot[newest];
+}
+
+/**
+ * @brief Release the snapshot held by RegMap_Acquire().
+ */
+void RegMap_Release(void)
+{
+  Reading = SNAPSHOT_NONE;
+}
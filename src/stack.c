@@ -0,0 +1,74 @@
+/**
+ * @file stack.c
+ *
+ * @brief Finds how much of the stack has been used since reset.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T11:20:48-0400
+ * @date Last modified: 2026-10-19T11:20:48-0400
+ *
+ * @details At reset, the startup code fills the stack region reserved by the
+ * linker, from <tt>__StackLimit</tt> up to <tt>__StackTop</tt>, with
+ * ::STACK_PAINT. The stack grows down from <tt>__StackTop</tt>, so the lowest
+ * word that no longer holds the pattern marks the deepest point the stack has
+ * reached, including any nested interrupt handlers.
+ *
+ * If Stack_HighWater() ever returns the same value as Stack_Size() then the
+ * stack has been completely used and has probably overflowed into the
+ * variables below it.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "stack.h"
+
+//
+// Stack boundaries, from the linker script
+//
+extern uint32_t __StackLimit[];
+extern uint32_t __StackTop[];
+
+/**
+ * @var StackPeak
+ * @brief The stack high-water mark, in bytes, updated by the main loop.
+ * @details This can be read with the debugger while the charger is running.
+ */
+volatile uint32_t StackPeak;
+
+/**
+ * @brief The size of the stack reserved by the linker.
+ *
+ * @return stack size in bytes
+ */
+uint32_t Stack_Size(void)
+{
+  return (uint32_t) __StackTop - (uint32_t) __StackLimit;
+}
+
+/**
+ * @brief Find the deepest stack use since reset.
+ * @details The stack is searched upward from its limit for the first word
+ * that is not the paint pattern. The search stops early at the first such
+ * word, so the time taken shrinks as the stack use grows.
+ *
+ * @return the largest number of bytes that have been used on the stack
+ */
+uint32_t Stack_HighWater(void)
+{
+  const uint32_t *word = __StackLimit;
+
+  while ((word < __StackTop) && (STACK_PAINT == *word))
+    word++;
+  return (uint32_t) __StackTop - (uint32_t) word;
+}
@@ -658,8 +658,15 @@ Default_Handler:
 @
 @  .global _bss, _ebss, data_start, data_size, data_load_start
   .global __bss_start__, __bss_end__, __data_start__, __data_end__, __etext
+  .global __StackLimit
+@
+@ Pattern written to the unused stack at reset, must agree with STACK_PAINT
+@   in stack.h
+@
+  .equ STACK_PAINT, 0xC5C5C5C5
 @
 @ At reset we have to do the C run-time stuff:
+@   Paint the stack so the high-water mark can be found later
 @   Clear the bss segment in RAM
 @   Copy the data segment from Flash to RAM
 @   Setup the clocks
@@ -672,8 +679,22 @@ Default_Handler:
   .global Reset_Handler
 Reset_Handler:
 @
+@ Fill the stack, from its limit up to the current stack pointer, with the
+@   paint pattern
+@
+  LDR     R0, =__StackLimit
+  MOV     R1, SP
+  LDR     R2, =STACK_PAINT
+PaintMore:
+  CMP     R0, R1
+  BHS     ClearBss
+  STR     R2, [R0]
+  ADDS    R0, #4
+  B       PaintMore
+@
 @ Clear the bss segment
 @
+ClearBss:
   MOVS    R2, #0
   LDR     R0, =__bss_start__
   LDR     R1, =__bss_end__
@@ -0,0 +1,88 @@
+/**
+ * @file telemetry.c
+ *
+ * @brief Streams a binary status record on the UART every control period.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T23:57:31-0400
+ * @date Last modified: 2026-10-19T23:57:31-0400
+ *
+ * @details The SysTick handler builds a ::Telemetry_t record and hands it to
+ * UART_Write(), which only copies it into the transmit buffer. A record is
+ * 16 bytes, so 100 records per second use about 14% of a 115200 baud link.
+ * If the buffer is ever full the record is dropped rather than waiting, and
+ * the count of dropped records is carried in every later record.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "pwm.h"
+#include "uart.h"
+#include "telemetry.h"
+
+#if TELEMETRY_ENABLE
+
+/**
+ * @var Sequence
+ * @brief Count of records built.
+ * @var TicksLeft
+ * @brief Number of ticks until the next record is due.
+ */
+static uint8_t Sequence;
+static uint32_t TicksLeft;
+
+/**
+ * @brief Build a record and queue it for the UART, every ::TELEMETRY_TICKS
+ * calls.
+ * @details This must only be called from the SysTick handler. It never
+ * waits for the UART.
+ *
+ * @param[in] voltage_mV the battery voltage
+ * @param[in] current_mA the charging current
+ */
+void Telemetry_Update(uint32_t voltage_mV, uint32_t current_mA)
+{
+  Telemetry_t record;
+  const uint8_t *p;
+  uint8_t sum;
+
+  if (TicksLeft > 1) {
+    TicksLeft--;
+    return;
+  }
+  TicksLeft = TELEMETRY_TICKS;
+
+  record.Sync0 = TELEMETRY_SYNC0;
+  record.Sync1 = TELEMETRY_SYNC1;
+  record.Sequence = Sequence++;
+  record.State = State;
+  record.Voltage_mV = voltage_mV;
+  record.Current_mA = current_mA;
+  record.Temperature = Temperature;
+  record.Duty = PWM_Duty();
+  record.Dropped = UARTTxDropped;
+  record.Fault = Fault;
+  //
+  // Sum everything after the sync bytes, then make the total come to 0
+  //
+  sum = 0;
+  for (p = &record.Sequence; p < &record.Checksum; p++)
+    sum += *p;
+  record.Checksum = -sum;
+
+  UART_Write((const uint8_t *) &record, TELEMETRY_SIZE);
+}
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file tempcomp.c
+ *
+ * @brief Adjusts the charging voltages for the battery temperature.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T14:48:09-0400
+ * @date Last modified: 2026-10-20T13:18:44-0400
+ *
+ * @details The voltage offset for each temperature is looked up in a table
+ * that is filled in at compile time, with one entry every
+ * 2^::COMP_STEP_SHIFT degrees C, and the offset between two entries is found
+ * by linear interpolation. The table is linear as built, but its entries may
+ * be replaced with a battery manufacturer's curve without changing any code.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "lm75.h"
+#include "tempcomp.h"
+
+/**
+ * @def COMP_STEP_SHIFT
+ * @brief The table has one entry every 2^COMP_STEP_SHIFT degrees C.
+ * @details A power of two step lets the table index and the interpolation
+ * fraction be found with shifts, since the Cortex-M0 has no divide
+ * instruction.
+ */
+#define COMP_STEP_SHIFT  3
+#define COMP_STEP_C      (1 << COMP_STEP_SHIFT)
+
+/**
+ * @def COMP_MV
+ * @brief The voltage offset for a temperature in whole degrees C.
+ */
+#define COMP_MV(c)  ((TEMP_COMP_REF_C - (c)) * TEMP_COMP_MV_PER_C)
+
+#if ((TEMP_COMP_MAX_C - TEMP_COMP_MIN_C) != (10 * COMP_STEP_C))
+#  error "TEMP_COMP_MIN_C and TEMP_COMP_MAX_C must be 10 table steps apart"
+#endif
+
+/**
+ * @var CompTable_mV
+ * @brief Voltage offset at each table step, starting at ::TEMP_COMP_MIN_C.
+ */
+static const int16_t CompTable_mV[] = {
+  COMP_MV(TEMP_COMP_MIN_C + 0 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 1 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 2 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 3 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 4 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 5 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 6 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 7 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 8 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 9 * COMP_STEP_C),
+  COMP_MV(TEMP_COMP_MIN_C + 10 * COMP_STEP_C)
+};
+static const uint32_t COMP_TABLE_LAST =
+  sizeof(CompTable_mV) / sizeof(CompTable_mV[0]) - 1;
+
+#if (TEMP_TREND_SAMPLES & (TEMP_TREND_SAMPLES - 1)) != 0
+#  error TEMP_TREND_SAMPLES must be a power of 2
+#endif
+
+/**
+ * @var TrendHistory
+ * @brief The last ::TEMP_TREND_SAMPLES temperatures given to
+ * TempComp_Predict().
+ * @var TrendCount
+ * @brief The number of samples recorded, it stops counting at
+ * ::TEMP_TREND_SAMPLES.
+ * @var TrendNext
+ * @brief Index in ::TrendHistory for the next sample.
+ */
+static int32_t TrendHistory[TEMP_TREND_SAMPLES];
+static uint32_t TrendCount, TrendNext;
+
+/**
+ * @brief Find the voltage offset for a battery temperature.
+ * @details Temperatures outside the table are clamped to its ends.
+ *
+ * @param[in] temperature in degrees C with ::TEMP_FRAC_BITS fractional bits
+ * @return the offset to add to each charging voltage, in mV
+ */
+int32_t TempComp_Offset(int32_t temperature)
+{
+  uint32_t position, index, fraction;
+
+  if (temperature <= (TEMP_COMP_MIN_C * (1 << TEMP_FRAC_BITS)))
+    return CompTable_mV[0];
+  if (temperature >= (TEMP_COMP_MAX_C * (1 << TEMP_FRAC_BITS)))
+    return CompTable_mV[COMP_TABLE_LAST];
+  position = (uint32_t) (temperature -
+                         (TEMP_COMP_MIN_C * (1 << TEMP_FRAC_BITS)));
+  index = position >> (COMP_STEP_SHIFT + TEMP_FRAC_BITS);
+  fraction = position & ((1uL << (COMP_STEP_SHIFT + TEMP_FRAC_BITS)) - 1);
+  return CompTable_mV[index] +
+    (((CompTable_mV[index + 1] - CompTable_mV[index]) * (int32_t) fraction)
+     >> (COMP_STEP_SHIFT + TEMP_FRAC_BITS));
+}
+
+/**
+ * @brief Compensate one charging voltage.
+ *
+ * @param[in] nominal_mV the setpoint at ::TEMP_COMP_REF_C
+ * @param[in] offset_mV the value returned by TempComp_Offset()
+ * @return the setpoint, limited to ::TEMP_COMP_MIN_MV .. ::TEMP_COMP_MAX_MV
+ */
+uint32_t TempComp_Setpoint(uint32_t nominal_mV, int32_t offset_mV)
+{
+  int32_t setpoint = (int32_t) nominal_mV + offset_mV;
+
+  if (setpoint < TEMP_COMP_MIN_MV)
+    return TEMP_COMP_MIN_MV;
+  if (setpoint > TEMP_COMP_MAX_MV)
+    return TEMP_COMP_MAX_MV;
+  return (uint32_t) setpoint;
+}
+
+/**
+ * @brief Predict the temperature from its recent trend.
+ * @details This should be called every ::TEMP_TREND_SEC seconds. The rise
+ * from the oldest sample in the history to the new one is scaled up by
+ * 2^::TEMP_PREDICT_SHIFT and added to the new sample. Until the history is
+ * full, the oldest sample available is used, so the prediction covers a
+ * shorter span but is never based on missing data.
+ *
+ * @param[in] hottest the value returned by LM75_Hottest()
+ * @return the predicted temperature, never less than @p hottest
+ */
+int32_t TempComp_Predict(int32_t hottest)
+{
+  int32_t oldest, rise;
+
+  if (TEMP_NONE == hottest)
+    return hottest;
+  if (TrendCount < TEMP_TREND_SAMPLES) {
+    oldest = TrendCount ? TrendHistory[0] : hottest;
+    TrendCount++;
+  } else {
+    oldest = TrendHistory[TrendNext];
+  }
+  TrendHistory[TrendNext] = hottest;
+  TrendNext = (TrendNext + 1) & (TEMP_TREND_SAMPLES - 1);
+  rise = hottest - oldest;
+  if (rise <= 0)
+    return hottest;
+  return hottest + (rise << TEMP_PREDICT_SHIFT);
+}
+
+/**
+ * @brief Derate a charging current for temperature.
+ * @details This is only called once every ::TEMP_TREND_SEC seconds, so the
+ * division does not matter.
+ *
+ * @param[in] nominal_mA the current with no derating
+ * @param[in] hottest the value returned by TempComp_Predict()
+ * @return the current, reduced linearly from ::TEMP_DERATE_START_C to zero at
+ * ::TEMP_DERATE_STOP_C
+ */
+uint32_t TempComp_Derate(uint32_t nominal_mA, int32_t hottest)
+{
+  const int32_t start = TEMP_DERATE_START_C * (1 << TEMP_FRAC_BITS);
+  const int32_t stop = TEMP_DERATE_STOP_C * (1 << TEMP_FRAC_BITS);
+
+  if (hottest <= start)
+    return nominal_mA;
+  if (hottest >= stop)
+    return 0;
+  return (nominal_mA * (uint32_t) (stop - hottest)) / (uint32_t) (stop - start);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file uart.c
+ *
+ * @brief Sends bytes from a ring buffer on the UART, one FIFO load per
+ * interrupt.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T23:57:31-0400
+ * @date Last modified: 2026-10-19T23:57:31-0400
+ *
+ * @details The writer copies bytes into ::TxBuffer and returns at once. The
+ * UART interrupt refills the 16-byte transmit FIFO each time it empties, so
+ * at 115200 baud there is one interrupt for every 16 bytes, about every
+ * 1.4 ms while data is flowing. ::TxHead is written only by the writer and
+ * ::TxTail only by the interrupt handler, as in queue.c. If a write does not
+ * fit it is discarded whole and counted, the writer never waits.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "uart.h"
+
+//
+// SysCon clock enable, and the pin functions for RXD and TXD
+//
+static const uint32_t SYSCON_SYSAHBCLKCTRL_UART = 1uL << 12;
+static const uint32_t IOCON_FUNC_Msk = 0x7 << 0;
+static const uint32_t IOCON_RXD      = 1uL << 0;
+static const uint32_t IOCON_TXD      = 1uL << 0;
+//
+// UART registers
+//
+static const uint32_t UART_LCR_8N1     = 0x3;
+static const uint32_t UART_LCR_DLAB    = 1uL << 7;
+static const uint32_t UART_FCR_ENABLE  = 0x7;       // enable and reset FIFOs
+static const uint32_t UART_FDR_NONE    = 0x10;      // no fractional divider
+static const uint32_t UART_IER_THRE    = 1uL << 1;
+static const uint32_t UART_IIR_ID_Msk  = 0x7 << 1;
+static const uint32_t UART_IIR_THRE    = 0x1 << 1;
+static const uint32_t UART_FIFO_SIZE   = 16;
+
+static const uint32_t TX_INDEX_Msk = UART_TX_SIZE - 1;
+
+/**
+ * @var TxBuffer
+ * @brief Bytes waiting to be sent.
+ * @var TxHead
+ * @brief Count of bytes ever written to ::TxBuffer.
+ * @var TxTail
+ * @brief Count of bytes ever moved from ::TxBuffer to the FIFO.
+ * @var TxActive
+ * @brief Non-zero while the FIFO is sending and an interrupt will follow.
+ */
+static uint8_t TxBuffer[UART_TX_SIZE];
+static volatile uint32_t TxHead;
+static volatile uint32_t TxTail;
+static volatile uint32_t TxActive;
+
+volatile uint32_t UARTTxDropped;
+
+/**
+ * @brief Set up the UART for ::UART_BAUD, 8N1, and enable its interrupt.
+ * @details The UART clock divider is set to match the AHB divider, so the
+ * UART is clocked at SystemCoreClock.
+ */
+void UART_Init(void)
+{
+  uint32_t divisor;
+
+  LPC_IOCON->PIO1_6 = (LPC_IOCON->PIO1_6 & ~IOCON_FUNC_Msk) | IOCON_RXD;
+  LPC_IOCON->PIO1_7 = (LPC_IOCON->PIO1_7 & ~IOCON_FUNC_Msk) | IOCON_TXD;
+  LPC_SYSCON->SYSAHBCLKCTRL |= SYSCON_SYSAHBCLKCTRL_UART;
+  LPC_SYSCON->UARTCLKDIV = LPC_SYSCON->SYSAHBCLKDIV;
+
+  divisor = (SystemCoreClock + 8 * UART_BAUD) / (16 * UART_BAUD);
+  LPC_UART->LCR = UART_LCR_8N1 | UART_LCR_DLAB;
+  LPC_UART->DLL = divisor & 0xFF;
+  LPC_UART->DLM = divisor >> 8;
+  LPC_UART->LCR = UART_LCR_8N1;
+  LPC_UART->FDR = UART_FDR_NONE;
+  LPC_UART->FCR = UART_FCR_ENABLE;
+
+  TxHead = 0;
+  TxTail = 0;
+  TxActive = 0;
+  UARTTxDropped = 0;
+  LPC_UART->IER = UART_IER_THRE;
+  NVIC_SetPriority(UART_IRQn, UART_IRQ_PRIORITY);
+  NVIC_EnableIRQ(UART_IRQn);
+}
+
+/**
+ * @private
+ * @brief Move up to a FIFO load of bytes from ::TxBuffer to the UART.
+ * @details Must only be called when the FIFO is empty, from the interrupt
+ * handler or with the UART interrupt disabled.
+ */
+static void FillFifo(void)
+{
+  uint32_t tail = TxTail;
+  uint32_t n;
+
+  for (n = 0; (n < UART_FIFO_SIZE) && (tail != TxHead); n++) {
+    LPC_UART->THR = TxBuffer[tail & TX_INDEX_Msk];
+    tail++;
+  }
+  TxTail = tail;
+  TxActive = (n != 0);
+}
+
+/**
+ * @brief Queue bytes to be sent.
+ * @details The bytes are either all queued or all discarded, so a record is
+ * never sent in part. If the UART is idle it is started here; only the UART
+ * interrupt is masked while that is done, for a FIFO load at most.
+ *
+ * @param[in] data the bytes
+ * @param[in] length the number of bytes
+ * @return 1 if the bytes were queued, 0 if there was not room for them
+ */
+uint32_t UART_Write(const uint8_t *data, uint32_t length)
+{
+  uint32_t head = TxHead;
+  uint32_t i;
+
+  if ((UART_TX_SIZE - (head - TxTail)) < length) {
+    UARTTxDropped++;
+    return 0;
+  }
+  for (i = 0; i < length; i++)
+    TxBuffer[(head + i) & TX_INDEX_Msk] = data[i];
+  __DMB();
+  TxHead = head + length;
+
+  NVIC_DisableIRQ(UART_IRQn);
+  if (!TxActive)
+    FillFifo();
+  NVIC_EnableIRQ(UART_IRQn);
+  return 1;
+}
+
+/**
+ * @brief The UART interrupt handler.
+ * @details The only interrupt enabled is for an empty transmit FIFO, which
+ * is refilled, or left idle if there is nothing more to send.
+ */
+void UART_IRQHandler(void)
+{
+  if ((LPC_UART->IIR & UART_IIR_ID_Msk) == UART_IIR_THRE)
+    FillFifo();
+}
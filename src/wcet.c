@@ -0,0 +1,99 @@
+/**
+ * @file wcet.c
+ *
+ * @brief Measures the worst-case execution time of every handler path.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T11:58:31-0400
+ * @date Last modified: 2026-10-19T11:58:31-0400
+ *
+ * @details Each measured handler reads the cycle counter on entry and then
+ * records the elapsed time on exit, against the path that it took. The time
+ * includes any higher-priority interrupts that preempted the handler, since
+ * those delay the handler's completion just as much as its own code does.
+ *
+ * The ::Wcet table has a fixed layout, so a copy of it taken with the
+ * debugger after a charging run can be compared line by line with a copy
+ * taken from another build. A path with a zero count was never exercised.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "wcet.h"
+
+#if WCET_MEASUREMENT
+//
+// Timer used as a free-running cycle counter
+//
+#  define CYCLE_TIMER         LPC_TMR32B0
+static const uint32_t SYSCON_SYSAHBCLKCTRL_CT32B0 = 1uL << 9;
+static const uint32_t TIMER_TCR_ENABLE = 1uL << 0;
+static const uint32_t TIMER_TCR_RESET  = 1uL << 1;
+
+/**
+ * @var Wcet
+ * @brief The execution time statistics for each handler path.
+ */
+volatile WcetPath_t Wcet[WCET_NUM_PATHS];
+
+/**
+ * @brief Clear the table and start the cycle counter.
+ * @details If the jitter measurement has already started the cycle counter
+ * then it is left running.
+ */
+void WCET_Init(void)
+{
+  uint32_t path;
+
+  for (path = 0; path < WCET_NUM_PATHS; path++) {
+    Wcet[path].Count = 0;
+    Wcet[path].Max = 0;
+  }
+  LPC_SYSCON->SYSAHBCLKCTRL |= SYSCON_SYSAHBCLKCTRL_CT32B0;
+  if (0 == (CYCLE_TIMER->TCR & TIMER_TCR_ENABLE)) {
+    CYCLE_TIMER->TCR = TIMER_TCR_RESET;
+    CYCLE_TIMER->PR = 0;
+    CYCLE_TIMER->MCR = 0;
+    CYCLE_TIMER->TCR = TIMER_TCR_ENABLE;
+  }
+}
+
+/**
+ * @brief Read the cycle counter.
+ *
+ * @return the current cycle count
+ */
+uint32_t WCET_Start(void)
+{
+  return CYCLE_TIMER->TC;
+}
+
+/**
+ * @brief Record the execution time of one pass through a path.
+ *
+ * @param[in] path one of the WCET_ index values
+ * @param[in] start the value returned by WCET_Start() on entry
+ */
+void WCET_Record(uint32_t path, uint32_t start)
+{
+  uint32_t cycles = CYCLE_TIMER->TC - start;
+
+  if (path >= WCET_NUM_PATHS)
+    return;
+  if (cycles > Wcet[path].Max)
+    Wcet[path].Max = cycles;
+  Wcet[path].Count++;
+}
+#endif
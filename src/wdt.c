@@ -0,0 +1,257 @@
+/**
+ * @file wdt.c
+ *
+ * @brief Watchdog timer that is fed only when every supervised task has met
+ * its deadline.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-19T09:12:40-0400
+ * @date Last modified: 2026-10-19T20:41:16-0400
+ *
+ * @details Each supervised task records the current service tick when it
+ * runs. Once per SysTick, WDT_Service() checks how long ago every task last
+ * checked in. If all of them are on time the watchdog is fed. If any task is
+ * late the PWM output is stopped at once, the late task is recorded in RAM
+ * that is not cleared at reset, and the watchdog is never fed again so the
+ * processor is reset within ::WDT_TIMEOUT_MS.
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "pwm.h"
+#include "wdt.h"
+//
+// Watchdog Mode Register, LPC_WDT->MOD
+//
+static const uint32_t WDT_MOD_WDEN    = 1uL << 0;
+static const uint32_t WDT_MOD_WDRESET = 1uL << 1;
+static const uint32_t WDT_MOD_WDINT   = 1uL << 3;
+//
+// The watchdog counter runs at one quarter of the watchdog clock
+//
+static const uint32_t WDT_COUNTS_PER_MS = WDT_CLK_FREQ / 4 / 1000;
+//
+// The warning interrupt register is only 10 bits wide
+//
+static const uint32_t WDT_WARNINT_MAX = 0x3FFuL;
+//
+// SysCon registers for clocking and reset status
+//
+static const uint32_t SYSCON_SYSAHBCLKCTRL_WDT = 1uL << 15;
+static const uint32_t SYSCON_WDTCLKSEL_IRC     = 0;
+static const uint32_t SYSCON_SYSRSTSTAT_WDT    = 1uL << 2;
+static const uint32_t SYSCON_SYSRSTSTAT_Msk    = 0x1FuL;
+//
+// Marks a valid failure record in the upper bits of ::FailureRecord
+//
+static const uint32_t RECORD_MAGIC     = 0xD06F0000uL;
+static const uint32_t RECORD_MAGIC_Msk = 0xFFFF0000uL;
+static const uint32_t RECORD_TASK_Msk  = 0x000000FFuL;
+
+/**
+ * @var ServiceTicks
+ * @brief Counts calls to WDT_Service(), one per SysTick.
+ * @var CheckInTicks
+ * @brief The value of ::ServiceTicks when each task last checked in.
+ */
+static volatile uint32_t ServiceTicks;
+static volatile uint32_t CheckInTicks[WDT_NUM_TASKS];
+
+/**
+ * @var Deadline
+ * @brief The allowed number of SysTicks between check-ins for each task.
+ */
+static const uint32_t Deadline[WDT_NUM_TASKS] = {
+  WDT_DEADLINE_CONTROL,
+  WDT_DEADLINE_ADC,
+  WDT_DEADLINE_UI,
+  WDT_DEADLINE_MAIN
+};
+
+/**
+ * @var FailedTask
+ * @brief The first task to miss its deadline since reset, or ::WDT_TASK_NONE.
+ * @var LastFailure
+ * @brief The task that caused the previous watchdog reset, or ::WDT_TASK_NONE.
+ */
+static volatile uint32_t FailedTask = WDT_TASK_NONE;
+static uint32_t LastFailure = WDT_TASK_NONE;
+
+/**
+ * @var FailureRecord
+ * @brief The failed task, tagged with ::RECORD_MAGIC, kept across a reset.
+ * @details The startup code only clears .bss and copies .data, so anything
+ * the linker script places in the NOLOAD .noinit section survives a watchdog
+ * reset.
+ */
+static uint32_t FailureRecord __attribute__ ((section(".noinit")));
+
+/**
+ * @brief Feed the watchdog.
+ * @details The two feed writes must not be separated by any other access to
+ * the watchdog registers, so interrupts are disabled for the feed sequence.
+ */
+static void Feed(void)
+{
+  __disable_irq();
+  LPC_WDT->FEED = 0xAA;
+  LPC_WDT->FEED = 0x55;
+  __enable_irq();
+}
+
+/**
+ * @brief Record a missed deadline and shut down the charger.
+ *
+ * @param[in] task the task that missed its deadline
+ */
+static void Fail(uint32_t task)
+{
+  if (WDT_TASK_NONE == FailedTask) {
+    FailedTask = task;
+    FailureRecord = RECORD_MAGIC | task;
+  }
+  PWM_Stop();
+}
+
+/**
+ * @brief Configure and start the watchdog timer.
+ *
+ * @details First the reset status is examined. If the last reset was caused
+ * by the watchdog and a valid failure record was left behind, the failed task
+ * is saved so it can be reported by WDT_LastFailure(). Any other kind of reset
+ * (power-on or the STOP button) discards the record.
+ *
+ * The watchdog is clocked from the IRC and set up so that it resets the
+ * processor when it times out. The feed window and the warning interrupt are
+ * only present on parts with the windowed watchdog; on other parts these
+ * writes are ignored.
+ *
+ * @warning Once started the watchdog cannot be stopped, so this must not be
+ * called until the SysTick interrupt is about to be started.
+ */
+void WDT_Init(void)
+{
+  uint32_t task;
+
+  if ((LPC_SYSCON->SYSRSTSTAT & SYSCON_SYSRSTSTAT_WDT) &&
+      ((FailureRecord & RECORD_MAGIC_Msk) == RECORD_MAGIC)) {
+    LastFailure = FailureRecord & RECORD_TASK_Msk;
+  } else {
+    LastFailure = WDT_TASK_NONE;
+  }
+  FailureRecord = 0;
+  LPC_SYSCON->SYSRSTSTAT = SYSCON_SYSRSTSTAT_Msk;
+
+  ServiceTicks = 0;
+  for (task = 0; task < WDT_NUM_TASKS; task++)
+    CheckInTicks[task] = 0;
+  FailedTask = WDT_TASK_NONE;
+  //
+  // Clock the watchdog from the IRC, undivided
+  //
+  LPC_SYSCON->SYSAHBCLKCTRL |= SYSCON_SYSAHBCLKCTRL_WDT;
+  LPC_SYSCON->WDTCLKSEL = SYSCON_WDTCLKSEL_IRC;
+  LPC_SYSCON->WDTCLKUEN = 0;
+  LPC_SYSCON->WDTCLKUEN = 1;
+  LPC_SYSCON->WDTCLKDIV = 1;
+
+  LPC_WDT->TC = WDT_TIMEOUT_MS * WDT_COUNTS_PER_MS;
+  LPC_WDT->WARNINT = WDT_WARNINT_MAX;
+  LPC_WDT->WINDOW = (WDT_TIMEOUT_MS - WDT_WINDOW_MS) * WDT_COUNTS_PER_MS;
+  LPC_WDT->MOD = WDT_MOD_WDEN | WDT_MOD_WDRESET;
+  NVIC_SetPriority(WDT_IRQn, WDT_IRQ_PRIORITY);
+  NVIC_EnableIRQ(WDT_IRQn);
+  //
+  // The watchdog does not start counting until the first feed
+  //
+  Feed();
+}
+
+/**
+ * @brief Record that a supervised task has run.
+ * @details This is called from interrupt handlers as well as from the main
+ * loop, so it does nothing more than a single 32-bit store.
+ *
+ * @param[in] task the task number, one of the WDT_TASK_ values
+ */
+void WDT_CheckIn(uint32_t task)
+{
+  CheckInTicks[task] = ServiceTicks;
+}
+
+/**
+ * @brief Check every task against its deadline and feed the watchdog.
+ * @details This must be called exactly once per SysTick. If any task has not
+ * checked in within its deadline then the charger is shut down and the
+ * watchdog is no longer fed.
+ */
+void WDT_Service(void)
+{
+  uint32_t task;
+
+  ServiceTicks++;
+  for (task = 0; task < WDT_NUM_TASKS; task++) {
+    if ((ServiceTicks - CheckInTicks[task]) > Deadline[task])
+      Fail(task);
+  }
+  if (WDT_TASK_NONE == FailedTask)
+    Feed();
+}
+
+/**
+ * @brief The task that missed its deadline before the last reset.
+ *
+ * @return the task number, or ::WDT_TASK_NONE if the last reset was not
+ *   caused by a missed deadline
+ */
+uint32_t WDT_LastFailure(void)
+{
+  return LastFailure;
+}
+
+/**
+ * @brief A message naming a failed task, suitable for the display.
+ *
+ * @param[in] task the task number
+ * @return pointer to a string of no more than 16 characters, which fits on
+ *   any supported display
+ */
+const char *WDT_FailureMessage(uint32_t task)
+{
+  switch (task) {
+    case WDT_TASK_CONTROL:
+      return "Watchdog: ctrl  ";
+    case WDT_TASK_ADC:
+      return "Watchdog: ADC   ";
+    case WDT_TASK_UI:
+      return "Watchdog: LCD   ";
+    case WDT_TASK_MAIN:
+      return "Watchdog: main  ";
+  }
+  return "Watchdog reset  ";
+}
+
+/**
+ * @brief The watchdog warning interrupt handler.
+ * @details The watchdog is about to reset the processor. If no task was found
+ * to be late then the SysTick handler itself has stopped running, so blame
+ * the control task. In either case the PWM output is shut off now rather
+ * than waiting for the reset.
+ */
+void WDT_IRQHandler(void)
+{
+  LPC_WDT->MOD |= WDT_MOD_WDINT;  // clear the interrupt
+  Fail(WDT_TASK_CONTROL);
+}
@@ -0,0 +1,267 @@
+/**
+ * @file bench_format.c
+ *
+ * @brief Print the cost of each kind of number conversion on the display.
+ * @details Format_Fixed() is called for each field that the SysTick handler
+ * fills in, with values spread evenly over the range the field can show,
+ * and the host instructions taken by each call are counted exactly, with
+ * the Cortex-M0 cycles they stand for estimated alongside (see icount.h and
+ * m0cost.h). The fewest, most and mean per conversion are printed for each
+ * field, and for Format_Div10() on its own. The spread between the fewest
+ * and the most shows how far the cost depends on the value.
+ *
+ * The voltage field is also converted from millivolts, as SysTick.c does
+ * it, and the same way with the repeated subtraction of Binary2BCD() that
+ * Format_Fixed() replaced, so that the two can be compared.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T12:44:52-0400
+ * @date Last modified: 2026-10-20T15:02:40-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <stdio.h>
+#include "LPC11xx.h"
+#include "format.h"
+#include "icount.h"
+
+//
+// Number of values tried in each field, from the lowest to the highest
+//
+#define VALUES  101
+
+/*
+ * A field on the display, as SysTick.c formats it
+ */
+typedef struct
+{
+  const char *Name;
+  uint32_t Width;
+  uint32_t Decimals;
+  uint32_t Flags;
+  int32_t Low;
+  int32_t High;
+} Field_t;
+
+static const Field_t Fields[] = {
+  {"voltage, 0.1 V", 4, 1, 0, 0, 165},
+  {"current, 0.1 A", 3, 1, 0, 0, 33},
+  {"temperature, C", 3, 0, 0, -99, 999},
+  {"charge, mAh", 6, 3, 0, 0, 99999},
+  {"energy, 0.1 Wh", 6, 1, 0, 0, 99999},
+  {"hours", 2, 0, FORMAT_ZERO_PAD, 0, 99},
+  {"minutes", 2, 0, FORMAT_ZERO_PAD, 0, 59},
+  {"sensor errors", 3, 0, 0, 0, 999}
+};
+#define NUM_FIELDS  (sizeof(Fields) / sizeof(Fields[0]))
+
+//
+// The battery voltages tried for the voltage field, in mV
+//
+#define MV_MAX  16500
+
+/**
+ * @brief Convert binary to BCD for display, as SysTick.c did before
+ * Format_Fixed().
+ * @details Binary values less than 100,000 decimal are converted to BCD. The
+ * resulting BCD values are packed into a 32-bit integer. There may be up to
+ * five valid BCD values.
+ *
+ * @param[in] binary_value binary integer to be converted to BCD
+ * @return    packed BCD representation
+ */
+static uint32_t Binary2BCD(uint32_t binary_value)
+{
+  uint32_t bcd_value = 0;
+
+  while (binary_value > 9999) {
+    bcd_value += 0x10000;
+    binary_value -= 10000;
+  }
+  while (binary_value > 999) {
+    bcd_value += 0x1000;
+    binary_value -= 1000;
+  }
+  while (binary_value > 99) {
+    bcd_value += 0x100;
+    binary_value -= 100;
+  }
+  while (binary_value > 9) {
+    bcd_value += 0x10;
+    binary_value -= 10;
+  }
+  bcd_value += binary_value;
+  return bcd_value;
+}
+
+/*
+ * The voltage field from millivolts, rounded to tenths of volts, as
+ * SysTick.c writes it now and as it did with Binary2BCD()
+ */
+static void Voltage(char *text, uint32_t mV)
+{
+  Format_Fixed(text, 4, Format_Div100(mV + 50), 1, 0);
+}
+
+static void VoltageBCD(char *text, uint32_t mV)
+{
+  uint32_t temp = Binary2BCD(mV + 50);
+
+  text[3] = (char) ((temp >> 8) & 0xF) + '0';
+  text[1] = (char) ((temp >> 12) & 0xF) + '0';
+  text[0] = (char) ((temp >> 16) & 0xF) + '0';
+}
+
+typedef struct
+{
+  const char *Name;
+  void (*Convert)(char *text, uint32_t mV);
+} Path_t;
+
+static const Path_t Paths[] = {
+  {"voltage from mV", Voltage},
+  {"Binary2BCD, old", VoltageBCD}
+};
+#define NUM_PATHS  (sizeof(Paths) / sizeof(Paths[0]))
+
+//
+// Rows of the table: the fields, Format_Div10(), and the voltage paths
+//
+#define DIV10_ROW  NUM_FIELDS
+#define PATH_ROW   (DIV10_ROW + 1)
+#define NUM_ROWS   (PATH_ROW + NUM_PATHS)
+
+/*
+ * Instructions or cycles taken by each row
+ */
+typedef struct
+{
+  uint32_t Min;
+  uint32_t Max;
+  uint32_t Total;
+} Cost_t;
+
+static Cost_t Insns[NUM_ROWS], Cycles[NUM_ROWS];
+
+static void Add(Cost_t *cost, uint32_t count)
+{
+  if ((0 == cost->Total) || (count < cost->Min))
+    cost->Min = count;
+  if (count > cost->Max)
+    cost->Max = count;
+  cost->Total += count;
+}
+
+static void Print(const char *name, const char *width, const char *decimals,
+                  const Cost_t *insns, const Cost_t *cycles)
+{
+  printf("%-16s %5s %8s %5u %5u %7.1f %5u %5u %7.1f\n", name, width,
+         decimals, (unsigned) insns->Min, (unsigned) insns->Max,
+         (double) insns->Total / VALUES, (unsigned) cycles->Min,
+         (unsigned) cycles->Max, (double) cycles->Total / VALUES);
+}
+
+/*
+ * Make the compiler work out the value before the count is read, rather
+ * than between the reads
+ */
+static inline void Ready(int32_t value)
+{
+  __asm__ volatile ("" : : "r" (value));
+}
+
+/*
+ * Counting is on only for this, and the table is printed after it
+ */
+static void Measure(void)
+{
+  char text[8];
+  uint64_t insns, cycles, insnsOverhead, cyclesOverhead;
+  int32_t value;
+  uint32_t field, i;
+  const Field_t *f;
+  char width[4], decimals[4];
+
+  ICount_Start();
+  //
+  // The counts between two reads of each, with nothing between. Both are
+  // read again straight after the call, before either is recorded.
+  //
+  cycles = ICycles;
+  insns = ICount;
+  insnsOverhead = ICount - insns;
+  cyclesOverhead = ICycles - cycles;
+  for (field = 0; field < NUM_FIELDS; field++) {
+    f = &Fields[field];
+    for (i = 0; i < VALUES; i++) {
+      value = f->Low + (int32_t) (((int64_t) (f->High - f->Low) * i) /
+                                  (VALUES - 1));
+      Ready(value);
+      cycles = ICycles;
+      insns = ICount;
+      Format_Fixed(text, f->Width, value, f->Decimals, f->Flags);
+      insns = ICount - insns - insnsOverhead;
+      cycles = ICycles - cycles - cyclesOverhead;
+      Add(&Insns[field], (uint32_t) insns);
+      Add(&Cycles[field], (uint32_t) cycles);
+    }
+  }
+  for (i = 0; i < VALUES; i++) {
+    value = (FORMAT_MAX * i) / (VALUES - 1);
+    Ready(value);
+    cycles = ICycles;
+    insns = ICount;
+    Format_Div10(value);
+    insns = ICount - insns - insnsOverhead;
+    cycles = ICycles - cycles - cyclesOverhead;
+    Add(&Insns[DIV10_ROW], (uint32_t) insns);
+    Add(&Cycles[DIV10_ROW], (uint32_t) cycles);
+  }
+  for (field = 0; field < NUM_PATHS; field++) {
+    for (i = 0; i < VALUES; i++) {
+      value = (MV_MAX * i) / (VALUES - 1);
+      Ready(value);
+      cycles = ICycles;
+      insns = ICount;
+      Paths[field].Convert(text, value);
+      insns = ICount - insns - insnsOverhead;
+      cycles = ICycles - cycles - cyclesOverhead;
+      Add(&Insns[PATH_ROW + field], (uint32_t) insns);
+      Add(&Cycles[PATH_ROW + field], (uint32_t) cycles);
+    }
+  }
+  ICount_Stop();
+
+  printf("Host instructions and estimated M0 cycles per conversion, "
+         "%u values each\n", (unsigned) VALUES);
+  printf("%-16s %5s %8s %19s %19s\n", "", "", "", "host instructions",
+         "M0 cycles");
+  printf("%-16s %5s %8s %5s %5s %7s %5s %5s %7s\n", "field", "width",
+         "decimals", "min", "max", "mean", "min", "max", "mean");
+  for (field = 0; field < NUM_FIELDS; field++) {
+    f = &Fields[field];
+    snprintf(width, sizeof(width), "%u", (unsigned) f->Width);
+    snprintf(decimals, sizeof(decimals), "%u", (unsigned) f->Decimals);
+    Print(f->Name, width, decimals, &Insns[field], &Cycles[field]);
+  }
+  Print("Format_Div10", "-", "-", &Insns[DIV10_ROW], &Cycles[DIV10_ROW]);
+  for (field = 0; field < NUM_PATHS; field++)
+    Print(Paths[field].Name, "4", "1", &Insns[PATH_ROW + field],
+          &Cycles[PATH_ROW + field]);
+}
+
+int main(void)
+{
+  return (0 == ICount_Run(Measure)) ? 0 : 1;
+}
@@ -0,0 +1,512 @@
+/**
+ * @file bench_wcet.c
+ *
+ * @brief Print the WCET table for the interrupt handlers, run on the host.
+ * @details The firmware is built with ::WCET_MEASUREMENT, and the cycle
+ * timer that wcet.c reads is replaced by an exact count of the host
+ * instructions executed, and then by the estimate of the Cortex-M0 cycles
+ * those instructions stand for (see icount.h and m0cost.h). The handlers
+ * are called as the NVIC would call them, against simulated peripherals:
+ * ADC_IRQHandler() and SysTick_Handler() once per tick, and I2C_IRQHandler()
+ * for each event on a simulated bus with two LM75 sensors. The main loop
+ * runs between ticks, with the LCD model of hd44780.c.
+ *
+ * The hooks of the simulated peripherals are left out of the estimate, but
+ * the test for a hook that the host makes on each register access is not,
+ * so the estimate is a little high for paths that touch many registers.
+ *
+ * Each scenario starts from reset in its own process, and their tables are
+ * merged; the scenarios are run once for each table. Between them they
+ * pass through every ::ChargerState, each fault that the SysTick handler
+ * detects, and every master status code from 0x00 to 0x58. A scenario that
+ * does not end in the expected state makes the run fail. The table has a
+ * fixed layout and no timing noise, so the output of two builds can be
+ * diffed; the counts are only comparable between builds made with the same
+ * host compiler.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T12:14:25-0400
+ * @date Last modified: 2026-10-20T13:42:06-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "LPC11xx.h"
+#include "SysTick.h"
+#include "charger.h"
+#include "adc.h"
+#include "i2c.h"
+#include "lm75.h"
+#include "LCD.h"
+#include "wdt.h"
+#include "wcet.h"
+#include "hd44780.h"
+#include "icount.h"
+
+#if !WCET_MEASUREMENT
+#error "Build with -DWCET_MEASUREMENT=1"
+#endif
+
+void ADC_IRQHandler(void);
+void SysTick_Handler(void);
+
+#define DEGREES(t)  ((int32_t) ((t) * (1 << TEMP_FRAC_BITS)))
+
+//
+// Status of the simulated controller when it is not asking for service
+//
+#define BUS_IDLE  0xF8
+
+//
+// Maximum ADC value + 1, and the number of pages the charging display has
+//
+#define ADC_COUNTS  (1 << ADC_BITS)
+#define PAGES       6
+
+/*
+ * A simulated LM75, answering reads of its temperature register
+ */
+typedef struct
+{
+  uint8_t Address;
+  uint8_t Present;
+  uint8_t NackData;
+  int32_t Temperature;
+} Sensor_t;
+
+static Sensor_t Sensors[] = {
+  {0x90, 1, 0, DEGREES(25)},
+  {LM75_BATTERY_ADDR, 1, 0, DEGREES(25)}
+};
+#define NUM_SENSORS  (sizeof(Sensors) / sizeof(Sensors[0]))
+
+/*
+ * The bus: the addressed sensor, the next byte it sends, the control bits
+ * written since the last event, and faults to inject on the next address
+ */
+static Sensor_t *Addressed;
+static uint32_t ReadIndex;
+static uint32_t ConSet, ConClr;
+static uint32_t LoseArbitration, BusError;
+static uint32_t InHandler, Dispatching;
+
+//
+// STAT is read-only to the firmware
+//
+#define STAT  (*(volatile uint32_t *) &HostI2C.STAT)
+
+/*
+ * The merged tables of every scenario, shared with the child processes:
+ * one in host instructions and one in estimated M0 cycles
+ */
+#define INSNS   0
+#define CYCLES  1
+static WcetPath_t (*Tables)[WCET_NUM_PATHS];
+static uint32_t Table;
+
+/*
+ * The I2C register hook. CONSET and CONCLR are write-only, so the bits
+ * written are collected before the next access can overwrite them.
+ */
+static void I2CLatch(void)
+{
+  ConSet |= HostI2C.CONSET;
+  ConClr |= HostI2C.CONCLR;
+  HostI2C.CONSET = 0;
+  HostI2C.CONCLR = 0;
+}
+
+/*
+ * The cycle timer hook, wcet.c reads the instruction count or the estimate
+ */
+static void Timer(void)
+{
+  HostTMR32B0.TC = (uint32_t) ((CYCLES == Table) ? ICycles : ICount);
+}
+
+/*
+ * Call an interrupt handler, counting its instructions
+ */
+static void Irq(void (*handler)(void))
+{
+  InHandler++;
+  ICount_Start();
+  handler();
+  ICount_Stop();
+  InHandler--;
+}
+
+static Sensor_t *Find(uint8_t address)
+{
+  uint32_t i;
+
+  for (i = 0; i < NUM_SENSORS; i++) {
+    if (Sensors[i].Present && (Sensors[i].Address == (address & ~RD_BIT)))
+      return &Sensors[i];
+  }
+  return 0;
+}
+
+/*
+ * Work out the status of the next event from the status of the last one
+ * and what the handler did about it. Returns BUS_IDLE if there is none.
+ */
+static uint32_t BusNext(void)
+{
+  uint32_t stat = STAT;
+  uint32_t set, clr;
+
+  I2CLatch();
+  set = ConSet;
+  clr = ConClr;
+  ConSet = 0;
+  ConClr = 0;
+  if (set & I2CONSET_STO) {
+    Addressed = 0;
+    stat = BUS_IDLE;
+  }
+  if (set & I2CONSET_STA) {
+    if (BusError) {
+      BusError = 0;
+      return 0x00;
+    }
+    return ((0x18 == stat) || (0x28 == stat)) ? 0x10 : 0x08;
+  }
+  switch (stat) {
+    case 0x08:
+    case 0x10:
+      if (LoseArbitration) {
+        LoseArbitration = 0;
+        return 0x38;
+      }
+      Addressed = Find(HostI2C.DAT);
+      ReadIndex = 0;
+      if (HostI2C.DAT & RD_BIT)
+        return Addressed ? 0x40 : 0x48;
+      return Addressed ? 0x18 : 0x20;
+    case 0x18:
+    case 0x28:
+      return Addressed->NackData ? 0x30 : 0x28;
+    case 0x40:
+    case 0x50:
+      HostI2C.DAT = (uint8_t) (Addressed->Temperature >> (8 - 8 * ReadIndex));
+      ReadIndex++;
+      if (set & I2CONSET_AA)
+        return 0x50;
+      if (clr & I2CONCLR_AAC)
+        return 0x58;
+      break;
+  }
+  return BUS_IDLE;
+}
+
+/*
+ * The NVIC. The I2C handler has the lowest priority, so it only runs when
+ * no other handler is running.
+ */
+static void Dispatch(void)
+{
+  uint32_t stat;
+
+  if (InHandler || Dispatching || HostIrqMasked ||
+      !(HostIrqEnabled & (1uL << I2C_IRQn)))
+    return;
+  Dispatching = 1;
+  while (BUS_IDLE != (stat = BusNext())) {
+    STAT = stat;
+    Irq(I2C_IRQHandler);
+  }
+  STAT = BUS_IDLE;
+  Dispatching = 0;
+}
+
+/*
+ * Set the ADC filters to the values they settle at for the given battery
+ * voltage and current, and the data registers to match
+ */
+static void Battery(uint32_t mV, uint32_t mA)
+{
+  uint32_t v = (mV * ADC_COUNTS) / V_MAX_MV;
+  uint32_t i = (mA * ADC_COUNTS) / I_MAX_MA;
+
+  RawVoltage = v * SAMPLES_TO_AVERAGE;
+  FastVoltage = v * SAMPLES_FAST_AVERAGE;
+  RawCurrent = i * SAMPLES_TO_AVERAGE;
+  HostADC.DR[VOLTAGE_CHANNEL] = v << 6;
+  HostADC.DR[CURRENT_CHANNEL] = i << 6;
+  HostADC.DR[VREF_25_CHANNEL] = ((2500 * ADC_COUNTS) / ADC_VREF_MV) << 6;
+}
+
+static void Button(uint32_t pressed)
+{
+  if (pressed)
+    HostGPIO1.DATA &= ~(1uL << BTN1_Pos);
+  else
+    HostGPIO1.DATA |= 1uL << BTN1_Pos;
+}
+
+/*
+ * One SysTick period: an ADC conversion, the SysTick handler, and a pass
+ * of the main loop
+ */
+static void Tick(uint32_t ticks)
+{
+  while (ticks--) {
+    Irq(ADC_IRQHandler);
+    Irq(SysTick_Handler);
+    WDT_CheckIn(WDT_TASK_MAIN);
+    I2CCheckTimeout();
+    LM75_Poll();
+    HD44780_Wait(1000000000 / TICKS_PER_SEC);
+    LCD_Poll();
+  }
+}
+
+/*
+ * Press Button 1 long enough to count, then release it
+ */
+static void Press(void)
+{
+  Button(1);
+  Tick(4);
+  Button(0);
+  Tick(1);
+}
+
+/*
+ * Power up as main() does, with the button released, a 12.5 V battery and
+ * both sensors at 25 C
+ */
+static void Reset(uint32_t state)
+{
+  HostDispatch = Dispatch;
+  HostI2CHook = I2CLatch;
+  HostTMR32B0Hook = Timer;
+  STAT = BUS_IDLE;
+  Button(0);
+  Battery(12500, 0);
+  State = state;
+  Fault = FAULT_NONE;
+  HD44780_Init();
+  ICount_Exclude(HostDispatch);
+  ICount_Exclude(HostI2CHook);
+  ICount_Exclude(HostTMR32B0Hook);
+  ICount_Exclude(HostGPIO0Hook);
+  LCD_Init();
+  WDT_Init();
+  I2CInit((uint32_t) I2CMASTER);
+  LM75_Init();
+  WCET_Init();
+}
+
+/*
+ * Start charging, and wait for the CC stage
+ */
+static void Start(void)
+{
+  Tick(5);
+  Press();
+}
+
+/*
+ * Check how a scenario ended, and add its table to the shared one
+ */
+static void Finish(const char *name, uint32_t state, uint32_t fault)
+{
+  uint32_t path;
+
+  if ((State != state) || (Fault != fault)) {
+    fprintf(stderr, "bench_wcet: %s ended in state %u fault %u, "
+            "expected state %u fault %u\n", name, (unsigned) State,
+            (unsigned) Fault, (unsigned) state, (unsigned) fault);
+    exit(1);
+  }
+  for (path = 0; path < WCET_NUM_PATHS; path++) {
+    Tables[Table][path].Count += Wcet[path].Count;
+    if (Wcet[path].Max > Tables[Table][path].Max)
+      Tables[Table][path].Max = Wcet[path].Max;
+  }
+}
+
+/*
+ * A complete charge: every page in every stage, long enough at full current
+ * for the charge and energy counters to carry
+ */
+static void Charge(void)
+{
+  uint32_t page;
+
+  Reset(WAIT4BUTTON);
+  Start();
+  Battery(12500, I_MAX_MA);
+  for (page = 0; page < PAGES; page++)
+    Press();
+  Tick(120);
+  Battery(13000, 1000);
+  Tick(10);
+  Battery(14500, 1000);
+  Tick(5);
+  Battery(14000, 1000);
+  Tick(5);
+  for (page = 0; page < PAGES; page++)
+    Press();
+  Battery(14400, 50);
+  Tick(5);
+  for (page = 0; page < PAGES; page++)
+    Press();
+  Battery(12800, 50);
+  Tick(10);
+  Finish("charge", TRICKLE, FAULT_NONE);
+}
+
+static void Calibrate(void)
+{
+  Reset(CALIBRATE);
+  Tick(20);
+  Finish("calibrate", CALIBRATE, FAULT_NONE);
+}
+
+static void Short(void)
+{
+  Reset(WAIT4BUTTON);
+  Start();
+  Battery(10000, 0);
+  Tick(10);
+  Finish("short", ERROR, FAULT_SHORT);
+}
+
+static void Open(void)
+{
+  Reset(WAIT4BUTTON);
+  Start();
+  Battery(14500, 1000);
+  Tick(5);
+  Battery(16000, 0);
+  Tick(10);
+  Finish("open", ERROR, FAULT_OPEN);
+}
+
+static void Overtemp(void)
+{
+  Reset(WAIT4BUTTON);
+  Start();
+  Battery(14400, 50);
+  Tick(5);
+  Sensors[0].Temperature = DEGREES(70);
+  Tick(TEMP_READ_TICKS * NUM_SENSORS * (TEMP_SAMPLES_TO_AVERAGE + 1));
+  Finish("overtemp", ERROR, FAULT_OVERTEMP);
+}
+
+static void SensorLost(void)
+{
+  Reset(WAIT4BUTTON);
+  Start();
+  Sensors[1].Present = 0;
+  Tick(TEMP_READ_TICKS * NUM_SENSORS * (TEMP_MISSED_READS + 1));
+  Finish("sensor lost", ERROR, FAULT_SENSOR);
+}
+
+/*
+ * The I2C status codes that the sensor reads never reach: writes, a data
+ * NACK, lost arbitration, a bus error, and an interrupt with nothing to do
+ */
+static void Bus(void)
+{
+  static I2CTransaction write;
+
+  Reset(WAIT4BUTTON);
+  write.Address = LM75_BATTERY_ADDR;
+  write.WriteLength = 2;
+  write.WriteData[0] = 1;
+  write.WriteData[1] = 0;
+  write.ReadLength = 0;
+  I2CSubmit(&write);
+  write.ReadLength = 2;
+  I2CSubmit(&write);
+  write.Address = 0x94;
+  I2CSubmit(&write);
+  write.Address = LM75_BATTERY_ADDR;
+  Sensors[1].NackData = 1;
+  I2CSubmit(&write);
+  Sensors[1].NackData = 0;
+  LoseArbitration = 1;
+  I2CSubmit(&write);
+  BusError = 1;
+  I2CSubmit(&write);
+  Tick(1);
+  Irq(I2C_IRQHandler);
+  Finish("bus", WAIT4BUTTON, FAULT_NONE);
+}
+
+static const char * const StateNames[TRICKLE + 1] = {
+  "ERROR", "CALIBRATE", "WAIT4BUTTON", "CHECK4BATT", "CC_CHARGE",
+  "CV_CHARGE", "TRICKLE"
+};
+
+static void Print(void)
+{
+  uint32_t path;
+  char name[24];
+
+  printf("%-22s %8s %10s %10s\n", "path", "passes", "max insns",
+         "M0 cycles");
+  for (path = 0; path < WCET_NUM_PATHS; path++) {
+    if (path <= WCET_SYSTICK + TRICKLE)
+      snprintf(name, sizeof(name), "SysTick %s", StateNames[path]);
+    else if (WCET_SYSTICK_FAULT == path)
+      snprintf(name, sizeof(name), "SysTick fault");
+    else if (WCET_ADC == path)
+      snprintf(name, sizeof(name), "ADC");
+    else if (WCET_I2C_OTHER == path)
+      snprintf(name, sizeof(name), "I2C other");
+    else
+      snprintf(name, sizeof(name), "I2C 0x%02X",
+               (unsigned) ((path - WCET_I2C) << 3));
+    printf("%-22s %8u %10u %10u\n", name,
+           (unsigned) Tables[INSNS][path].Count,
+           (unsigned) Tables[INSNS][path].Max,
+           (unsigned) Tables[CYCLES][path].Max);
+  }
+}
+
+int main(void)
+{
+  static void (* const scenarios[])(void) = {
+    Charge, Calibrate, Short, Open, Overtemp, SensorLost, Bus
+  };
+  uint32_t i;
+
+  Tables = mmap(0, 2 * sizeof(Wcet), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == Tables) {
+    perror("bench_wcet: mmap");
+    return 1;
+  }
+  for (Table = INSNS; Table <= CYCLES; Table++) {
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+      if (0 != ICount_Run(scenarios[i]))
+        return 1;
+    }
+  }
+  for (i = 0; i < WCET_NUM_PATHS; i++) {
+    if (Tables[INSNS][i].Count != Tables[CYCLES][i].Count) {
+      fprintf(stderr, "bench_wcet: the runs took different paths\n");
+      return 1;
+    }
+  }
+  Print();
+  return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file check.h
+ *
+ * @brief Minimal checks for the host tests.
+ * @details Each failed check prints its location and the values involved,
+ * and the test program exits with the number of failures.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:21:47-0400
+ * @date Last modified: 2026-10-20T11:21:47-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _CHECK_H_
+#  define _CHECK_H_
+
+#  include <stdio.h>
+#  include <string.h>
+
+static unsigned CheckCount, CheckFailures;
+
+#  define CHECK(cond)                                                  \
+  do {                                                                 \
+    CheckCount++;                                                      \
+    if (!(cond)) {                                                     \
+      CheckFailures++;                                                 \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);  \
+    }                                                                  \
+  } while (0)
+
+#  define CHECK_EQ(actual, expected)                                   \
+  do {                                                                 \
+    long long a_ = (long long) (actual), e_ = (long long) (expected);  \
+    CheckCount++;                                                      \
+    if (a_ != e_) {                                                    \
+      CheckFailures++;                                                 \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+             #actual, a_, e_);                                         \
+    }                                                                  \
+  } while (0)
+
+#  define CHECK_STR(actual, expected)                                  \
+  do {                                                                 \
+    const char *a_ = (actual), *e_ = (expected);                       \
+    CheckCount++;                                                      \
+    if (0 != strcmp(a_, e_)) {                                         \
+      CheckFailures++;                                                 \
+      printf("%s:%d: %s is\n  \"%s\", expected\n  \"%s\"\n",           \
+             __FILE__, __LINE__, #actual, a_, e_);                     \
+    }                                                                  \
+  } while (0)
+
+//
+// Print the totals, and return the exit status for main()
+//
+static inline int CheckSummary(const char *name)
+{
+  printf("%s: %u checks, %u failed\n", name, CheckCount, CheckFailures);
+  return (0 == CheckFailures) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,320 @@
+/**
+ * @file hd44780.c
+ *
+ * @brief Host model of an HD44780 LCD controller on the 4-bit interface.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:48:12-0400
+ * @date Last modified: 2026-10-20T11:48:12-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "LPC11xx.h"
+#include "charger.h"
+#include "LCD.h"
+#include "hd44780.h"
+
+HD44780_t HD44780;
+
+static const uint32_t CTRL_Msk = 0x7 << LCD_CTRL_Pos;
+static const uint32_t DATA_Msk = 0xF << LCD_DATA_Pos;
+static const uint32_t RS = 1 << LCD_CTRL_Pos;
+static const uint32_t RW = 1 << (LCD_CTRL_Pos + 1);
+static const uint32_t EN = 1 << (LCD_CTRL_Pos + 2);
+
+/* Clocks for each pass through the driver's delay() loop on the target */
+static const uint32_t LOOP_CYCLES = 4;
+/* At least one clock for each GPIO access, a store takes two on the M0 */
+static const uint32_t ACCESS_CYCLES = 1;
+
+/* Display RAM address of each row, as the rows of a module are wired */
+static const uint8_t ROW_ADDR[4] = {
+  0x00, 0x40, LCD_COLS, 0x40 + LCD_COLS
+};
+
+static uint64_t LastAccess;     /* Time of the last port access */
+static uint32_t LastCtrl;       /* RS, RW and EN after that access */
+static uint32_t LastData;       /* The data nibble after that access */
+static uint64_t CtrlTime;       /* When RS or RW last changed */
+static uint64_t DataTime;       /* When the data pins last changed */
+static uint64_t EnRise, EnFall;
+static uint64_t BusyUntil;
+static uint32_t Phase;          /* 1 after the first nibble of a pair */
+static uint32_t PhaseRead;      /* The first nibble of the pair was read */
+static uint32_t HighNibble;     /* The first nibble written */
+static uint32_t Out;            /* The nibble the LCD drives for a read */
+
+static uint64_t Cycles(uint32_t ns)
+{
+  return ((uint64_t) ns * SystemCoreClock + 999999999) / 1000000000;
+}
+
+/*
+ * Times are rounded down, so a limit met only by rounding is still broken
+ */
+static void Check(uint32_t *errors, uint32_t *min, uint64_t since,
+                  uint64_t now, uint32_t limit)
+{
+  uint32_t ns = (now - since) * 1000000000 / SystemCoreClock;
+
+  if (ns < *min)
+    *min = ns;
+  if (ns < limit)
+    (*errors)++;
+}
+
+static void Advance(void)
+{
+  uint32_t up = HD44780.EntryMode & 0x2;
+
+  if (HD44780.InCGRAM) {
+    HD44780.Address = (HD44780.Address + (up ? 1 : 0x3F)) & 0x3F;
+  } else if (HD44780.TwoLines) {
+    if (up)
+      HD44780.Address = (0x27 == HD44780.Address) ? 0x40 :
+          (0x67 == HD44780.Address) ? 0x00 : HD44780.Address + 1;
+    else
+      HD44780.Address = (0x40 == HD44780.Address) ? 0x27 :
+          (0x00 == HD44780.Address) ? 0x67 : HD44780.Address - 1;
+  } else {
+    HD44780.Address = (HD44780.Address + (up ? 1 : 79)) % 80;
+  }
+}
+
+/*
+ * Carry out a command or character write that finished at time t. The
+ * display shift is not modelled, since the driver never uses it.
+ */
+static void Execute(uint32_t rs, uint8_t byte, uint64_t t)
+{
+  if (t < BusyUntil)
+    HD44780.BusyErrors++;
+  BusyUntil = t + Cycles(HD44780_EXEC_NS);
+  if (rs) {
+    if (HD44780.InCGRAM)
+      HD44780.CGRAM[HD44780.Address & 0x3F] = byte;
+    else
+      HD44780.DDRAM[HD44780.Address & 0x7F] = byte;
+    HD44780.Characters++;
+    Advance();
+    return;
+  }
+  HD44780.Commands++;
+  if (byte & 0x80) {
+    HD44780.Address = byte & 0x7F;
+    HD44780.InCGRAM = 0;
+  } else if (byte & 0x40) {
+    HD44780.Address = byte & 0x3F;
+    HD44780.InCGRAM = 1;
+  } else if (byte & 0x20) {
+    if (!HD44780.FourBit && !(byte & 0x10))
+      Phase = 0;
+    HD44780.FourBit = !(byte & 0x10);
+    HD44780.TwoLines = (byte >> 3) & 1;
+  } else if (byte & 0x10) {
+    if (!(byte & 0x08)) {
+      HD44780.EntryMode ^= (byte & 0x04) ? 0 : 0x2;
+      Advance();
+      HD44780.EntryMode ^= (byte & 0x04) ? 0 : 0x2;
+    }
+  } else if (byte & 0x08) {
+    HD44780.DisplayOn = (byte >> 2) & 1;
+    HD44780.Cursor = byte & 0x3;
+  } else if (byte & 0x04) {
+    HD44780.EntryMode = byte & 0x3;
+  } else if (byte & 0x02) {
+    HD44780.Address = 0;
+    HD44780.InCGRAM = 0;
+    BusyUntil = t + Cycles(HD44780_CLEAR_NS);
+  } else if (byte & 0x01) {
+    memset(HD44780.DDRAM, ' ', sizeof(HD44780.DDRAM));
+    HD44780.Address = 0;
+    HD44780.InCGRAM = 0;
+    HD44780.EntryMode |= 0x2;
+    BusyUntil = t + Cycles(HD44780_CLEAR_NS);
+  }
+}
+
+static void Rise(uint32_t ctrl, uint64_t t)
+{
+  uint8_t byte;
+
+  Check(&HD44780.Errors.Setup, &HD44780.Min.Setup, CtrlTime, t, LCD_TAS);
+  Check(&HD44780.Errors.Low, &HD44780.Min.Low, EnFall, t, LCD_TEL);
+  EnRise = t;
+  if (!(ctrl & RW))
+    return;
+  if (ctrl & RS) {
+    byte = HD44780.InCGRAM ? HD44780.CGRAM[HD44780.Address & 0x3F] :
+        HD44780.DDRAM[HD44780.Address & 0x7F];
+  } else {
+    byte = ((t < BusyUntil) ? 0x80 : 0) | (HD44780.Address & 0x7F);
+    if (!HD44780.FourBit || !Phase)
+      HD44780.BusyReads++;
+  }
+  Out = (!HD44780.FourBit || !Phase) ? (byte >> 4) : (byte & 0xF);
+}
+
+static void Fall(uint64_t t)
+{
+  Check(&HD44780.Errors.High, &HD44780.Min.High, EnRise, t, LCD_TEH);
+  EnFall = t;
+  if (LastCtrl & RW) {
+    if (HD44780.FourBit) {
+      if (Phase && !PhaseRead)
+        HD44780.StepErrors++;
+      PhaseRead = 1;
+      Phase = !Phase;
+    }
+    return;
+  }
+  Check(&HD44780.Errors.DataSetup, &HD44780.Min.DataSetup, DataTime, t,
+        LCD_TDS);
+  if (!HD44780.FourBit) {
+    Execute(LastCtrl & RS, LastData << 4, t);
+  } else if (!Phase) {
+    HighNibble = LastData;
+    PhaseRead = 0;
+    Phase = 1;
+  } else {
+    Phase = 0;
+    if (PhaseRead)
+      HD44780.StepErrors++;
+    else
+      Execute(LastCtrl & RS, (HighNibble << 4) | LastData, t);
+  }
+}
+
+/*
+ * Called before every access to port 0. Any change to the pins was made by
+ * the previous access, so it is dated at the time of that access.
+ */
+static void Sync(void)
+{
+  volatile uint32_t *pin = HostGPIO0.MASKED_ACCESS;
+  uint64_t t = LastAccess;
+  uint64_t now;
+  uint32_t ctrl = pin[CTRL_Msk] & CTRL_Msk;
+  uint32_t data = (pin[DATA_Msk] & DATA_Msk) >> LCD_DATA_Pos;
+  uint32_t driven = (DATA_Msk == (HostGPIO0.DIR & DATA_Msk));
+  uint32_t rise = (ctrl & EN) && !(LastCtrl & EN);
+  uint32_t fall = !(ctrl & EN) && (LastCtrl & EN);
+
+  HD44780.Cycles += ACCESS_CYCLES;
+  now = HD44780.Cycles;
+  if (fall)
+    Fall(t);
+  if ((ctrl ^ LastCtrl) & (RS | RW)) {
+    if ((ctrl & EN) && !rise)
+      HD44780.Errors.Setup++;
+    else
+      Check(&HD44780.Errors.Hold, &HD44780.Min.Hold, EnFall, t,
+            HD44780_TH);
+    CtrlTime = t;
+  }
+  if (driven && (data != LastData)) {
+    Check(&HD44780.Errors.Hold, &HD44780.Min.Hold, EnFall, t, HD44780_TH);
+    DataTime = t;
+    LastData = data;
+  }
+  if (rise)
+    Rise(ctrl, t);
+  if ((ctrl & EN) && (ctrl & RW) && !driven) {
+    // This access may be the read, so the data must be valid by now
+    Check(&HD44780.Errors.Read, &HD44780.Min.Read, EnRise, now, LCD_TDA);
+    pin[DATA_Msk] = (((now - EnRise) >= Cycles(LCD_TDA)) ? Out : ~Out)
+        << LCD_DATA_Pos & DATA_Msk;
+  }
+  LastCtrl = ctrl;
+  LastAccess = now;
+}
+
+void HD44780_Delay(uint32_t loops)
+{
+  HD44780.Cycles += (uint64_t) loops * LOOP_CYCLES;
+}
+
+void HD44780_Wait(uint32_t ns)
+{
+  HD44780.Cycles += Cycles(ns);
+}
+
+void HD44780_Init(void)
+{
+  uint32_t seed = 12345;
+  uint32_t i;
+
+  memset(&HD44780, 0, sizeof(HD44780));
+  memset(&HD44780.Min, 0xFF, sizeof(HD44780.Min));
+  // The RAM holds garbage at power up
+  for (i = 0; i < sizeof(HD44780.DDRAM); i++) {
+    seed = seed * 1103515245 + 12345;
+    HD44780.DDRAM[i] = seed >> 24;
+  }
+  for (i = 0; i < sizeof(HD44780.CGRAM); i++) {
+    seed = seed * 1103515245 + 12345;
+    HD44780.CGRAM[i] = (seed >> 24) & 0x1F;
+  }
+  // Powered up long ago, in 8-bit mode, with the address incrementing
+  HD44780.EntryMode = 0x2;
+  HD44780.Cycles = SystemCoreClock;
+  LastAccess = HD44780.Cycles;
+  HostGPIO0.DIR = 0;
+  HostGPIO0.MASKED_ACCESS[CTRL_Msk] = 0;
+  HostGPIO0.MASKED_ACCESS[DATA_Msk] = 0;
+  LastCtrl = 0;
+  LastData = 0;
+  CtrlTime = DataTime = EnRise = EnFall = 0;
+  BusyUntil = 0;
+  Phase = 0;
+  PhaseRead = 0;
+  HostGPIO0Hook = Sync;
+}
+
+void HD44780_Row(uint32_t row, char *text)
+{
+  uint32_t col;
+
+  for (col = 0; col < LCD_COLS; col++)
+    text[col] = HD44780.DDRAM[(ROW_ADDR[row] + col) & 0x7F];
+  text[LCD_COLS] = '\0';
+}
+
+void HD44780_Print(void)
+{
+  char text[LCD_COLS + 1];
+  uint32_t row, col;
+
+  printf("+%.*s+\n", LCD_COLS, "--------------------");
+  for (row = 0; row < LCD_ROWS; row++) {
+    HD44780_Row(row, text);
+    for (col = 0; col < LCD_COLS; col++) {
+      if ((uint8_t) text[col] < 8)
+        text[col] += '0';
+      else if ((uint8_t) text[col] == 0xFF)
+        text[col] = '#';
+    }
+    printf("|%s|\n", text);
+  }
+  printf("+%.*s+\n", LCD_COLS, "--------------------");
+}
+
+uint32_t HD44780_ErrorCount(void)
+{
+  return HD44780.Errors.Setup + HD44780.Errors.DataSetup +
+      HD44780.Errors.Hold + HD44780.Errors.High + HD44780.Errors.Low +
+      HD44780.Errors.Read + HD44780.BusyErrors + HD44780.StepErrors;
+}
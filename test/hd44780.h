@@ -0,0 +1,112 @@
+/**
+ * @file hd44780.h
+ *
+ * @brief Host model of an HD44780 LCD controller on the 4-bit interface.
+ * @details The model watches the LCD pins on GPIO port 0 through the host
+ * peripheral hook, and keeps time from the delay loops the driver runs, see
+ * ::LCD_DELAY_HOOK. It decodes every enable pulse into nibbles, commands and
+ * characters, answers busy flag reads, and keeps the display RAM, so a test
+ * can read the screen as text. Each pulse is checked against the setup, hold
+ * and pulse width limits in LCD.h, and against the busy time of the last
+ * command.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:48:12-0400
+ * @date Last modified: 2026-10-20T11:48:12-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _HD44780_H_
+#  define _HD44780_H_
+
+#  include <stdint.h>
+
+/**
+ * @def HD44780_TH
+ * @brief The LCD's required data and RS/RW hold time after EN falls
+ * (nanoseconds).
+ * @def HD44780_EXEC_NS
+ * @brief Execution time of most commands and of a character write.
+ * @def HD44780_CLEAR_NS
+ * @brief Execution time of the clear and home commands.
+ */
+#  define HD44780_TH           10
+#  define HD44780_EXEC_NS      37000
+#  define HD44780_CLEAR_NS     1520000
+
+/**
+ * @brief One value for each timing limit of the interface.
+ */
+typedef struct
+{
+  uint32_t Setup;         ///< RS/RW setup before EN rises, ::LCD_TAS
+  uint32_t DataSetup;     ///< Data setup before EN falls, ::LCD_TDS
+  uint32_t Hold;          ///< Data and RS/RW hold after EN falls
+  uint32_t High;          ///< EN high time, ::LCD_TEH
+  uint32_t Low;           ///< EN low time, ::LCD_TEL
+  uint32_t Read;          ///< EN rising to the data being read, ::LCD_TDA
+} HD44780Times_t;
+
+/**
+ * @brief The state of the model.
+ */
+typedef struct
+{
+  uint64_t Cycles;        ///< Time since HD44780_Init(), system clocks
+  uint32_t FourBit;       ///< Non-zero once in 4-bit mode
+  uint32_t TwoLines;      ///< The N bit of the last function set
+  uint32_t DisplayOn;     ///< The D bit of the last display control
+  uint32_t Cursor;        ///< The C and B bits of the last display control
+  uint32_t EntryMode;     ///< The I/D and S bits of the last entry mode
+  uint32_t Address;       ///< The address counter
+  uint32_t InCGRAM;       ///< Non-zero if Address is in CGRAM
+  uint8_t DDRAM[0x80];    ///< Display RAM, by address
+  uint8_t CGRAM[0x40];    ///< Character generator RAM
+  uint32_t Commands;      ///< Commands executed
+  uint32_t Characters;    ///< Characters written to either RAM
+  uint32_t BusyReads;     ///< Busy flag reads
+  uint32_t BusyErrors;    ///< Commands or characters written while busy
+  uint32_t StepErrors;    ///< Nibble pairs that mixed a read and a write
+  HD44780Times_t Errors;  ///< Number of times each limit was broken
+  HD44780Times_t Min;     ///< Shortest time seen for each, nanoseconds
+} HD44780_t;
+
+extern HD44780_t HD44780;
+
+//
+// Power up the model with random RAM, and install the GPIO port 0 hook
+//
+void HD44780_Init(void);
+//
+// Advance time by the given delay() loops, the LCD_DELAY_HOOK
+//
+void HD44780_Delay(uint32_t loops);
+//
+// Advance time, for the main loop between LCD calls
+//
+void HD44780_Wait(uint32_t ns);
+//
+// Copy one row of the screen, as it would look, into text
+//
+void HD44780_Row(uint32_t row, char *text);
+//
+// Print the screen, with custom characters as digits
+//
+void HD44780_Print(void);
+//
+// Total of all the errors
+//
+uint32_t HD44780_ErrorCount(void);
+
+#endif
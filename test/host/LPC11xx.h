@@ -0,0 +1,187 @@
+/**
+ * @file LPC11xx.h
+ *
+ * @brief Host stand-in for the device header, used by the tests in test/.
+ * @details The real register map is included unchanged, but the peripheral
+ * pointers are redirected to ordinary variables, and the Cortex-M0 core
+ * functions are replaced. Each peripheral has a hook that is called just
+ * before every register access, which lets a simulator see the effect of the
+ * previous access and update the registers the firmware is about to read.
+ * Enabling an interrupt calls ::HostDispatch, which runs any interrupt
+ * handler whose peripheral is asking for service.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:02:14-0400
+ * @date Last modified: 2026-10-20T11:02:14-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _HOST_LPC11XX_H_
+#  define _HOST_LPC11XX_H_
+
+#  include <stdint.h>
+
+//
+// Keep the real core header out, everything it provides is replaced below
+//
+#  define __CORE_CM0_H_GENERIC
+#  define __CMSIS_GENERIC
+#  define __I     volatile const
+#  define __O     volatile
+#  define __IO    volatile
+#  define __ASM   __asm
+#  define __INLINE inline
+
+#  include "../../inc/LPC11xx.h"
+
+/**
+ * @brief Hook called before every access to a peripheral, may be null.
+ */
+typedef void (*HostHook_t)(void);
+
+/**
+ * @def HOST_PERIPHERAL
+ * @brief Declare the variable that stands in for a peripheral, its hook, and
+ * the function that the peripheral pointer macro calls.
+ */
+#  define HOST_PERIPHERAL(name, type)                                 \
+  extern type Host##name;                                             \
+  extern HostHook_t Host##name##Hook;                                 \
+  static inline type *Host_##name(void)                               \
+  {                                                                   \
+    if (0 != Host##name##Hook)                                        \
+      Host##name##Hook();                                             \
+    return &Host##name;                                               \
+  }
+
+HOST_PERIPHERAL(I2C, LPC_I2C_TypeDef)
+HOST_PERIPHERAL(WDT, LPC_WDT_TypeDef)
+HOST_PERIPHERAL(UART, LPC_UART_TypeDef)
+HOST_PERIPHERAL(TMR16B0, LPC_TMR_TypeDef)
+HOST_PERIPHERAL(TMR16B1, LPC_TMR_TypeDef)
+HOST_PERIPHERAL(TMR32B0, LPC_TMR_TypeDef)
+HOST_PERIPHERAL(TMR32B1, LPC_TMR_TypeDef)
+HOST_PERIPHERAL(ADC, LPC_ADC_TypeDef)
+HOST_PERIPHERAL(PMU, LPC_PMU_TypeDef)
+HOST_PERIPHERAL(FLASHCTRL, LPC_FLASHCTRL_Type)
+HOST_PERIPHERAL(SSP0, LPC_SSP_TypeDef)
+HOST_PERIPHERAL(SSP1, LPC_SSP_TypeDef)
+HOST_PERIPHERAL(CAN, LPC_CAN_TypeDef)
+HOST_PERIPHERAL(IOCON, LPC_IOCON_TypeDef)
+HOST_PERIPHERAL(SYSCON, LPC_SYSCON_TypeDef)
+HOST_PERIPHERAL(GPIO0, LPC_GPIO_TypeDef)
+HOST_PERIPHERAL(GPIO1, LPC_GPIO_TypeDef)
+HOST_PERIPHERAL(GPIO2, LPC_GPIO_TypeDef)
+HOST_PERIPHERAL(GPIO3, LPC_GPIO_TypeDef)
+
+#  undef LPC_I2C
+#  undef LPC_WDT
+#  undef LPC_UART
+#  undef LPC_TMR16B0
+#  undef LPC_TMR16B1
+#  undef LPC_TMR32B0
+#  undef LPC_TMR32B1
+#  undef LPC_ADC
+#  undef LPC_PMU
+#  undef LPC_FLASHCTRL
+#  undef LPC_SSP0
+#  undef LPC_SSP1
+#  undef LPC_CAN
+#  undef LPC_IOCON
+#  undef LPC_SYSCON
+#  undef LPC_GPIO0
+#  undef LPC_GPIO1
+#  undef LPC_GPIO2
+#  undef LPC_GPIO3
+
+#  define LPC_I2C        (Host_I2C())
+#  define LPC_WDT        (Host_WDT())
+#  define LPC_UART       (Host_UART())
+#  define LPC_TMR16B0    (Host_TMR16B0())
+#  define LPC_TMR16B1    (Host_TMR16B1())
+#  define LPC_TMR32B0    (Host_TMR32B0())
+#  define LPC_TMR32B1    (Host_TMR32B1())
+#  define LPC_ADC        (Host_ADC())
+#  define LPC_PMU        (Host_PMU())
+#  define LPC_FLASHCTRL  (Host_FLASHCTRL())
+#  define LPC_SSP0       (Host_SSP0())
+#  define LPC_SSP1       (Host_SSP1())
+#  define LPC_CAN        (Host_CAN())
+#  define LPC_IOCON      (Host_IOCON())
+#  define LPC_SYSCON     (Host_SYSCON())
+#  define LPC_GPIO0      (Host_GPIO0())
+#  define LPC_GPIO1      (Host_GPIO1())
+#  define LPC_GPIO2      (Host_GPIO2())
+#  define LPC_GPIO3      (Host_GPIO3())
+
+/**
+ * @var HostIrqEnabled
+ * @brief One bit per interrupt, set while it is enabled in the NVIC.
+ * @var HostIrqPriority
+ * @brief The priority last set for each interrupt.
+ * @var HostIrqMasked
+ * @brief Non-zero while interrupts are disabled with __disable_irq().
+ * @var HostDispatch
+ * @brief Called whenever an interrupt may have become deliverable, may be
+ * null.
+ */
+extern volatile uint32_t HostIrqEnabled;
+extern volatile uint32_t HostIrqPriority[32];
+extern volatile uint32_t HostIrqMasked;
+extern HostHook_t HostDispatch;
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+  HostIrqEnabled |= 1uL << IRQn;
+  if ((0 != HostDispatch) && !HostIrqMasked)
+    HostDispatch();
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+  HostIrqEnabled &= ~(1uL << IRQn);
+}
+
+static inline void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+  HostIrqPriority[IRQn] = priority;
+}
+
+static inline void __disable_irq(void)
+{
+  HostIrqMasked = 1;
+}
+
+static inline void __enable_irq(void)
+{
+  HostIrqMasked = 0;
+  if (0 != HostDispatch)
+    HostDispatch();
+}
+
+static inline void __NOP(void)
+{
+}
+
+static inline void __DMB(void)
+{
+  __asm volatile ("":::"memory");
+}
+
+static inline void __DSB(void)
+{
+  __asm volatile ("":::"memory");
+}
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file host.c
+ *
+ * @brief The host variables that stand in for the LPC1114 peripherals.
+ * @details This also holds the globals that main.c defines on the target,
+ * and the clock frequency that system_LPC11xx.c would set.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:06:40-0400
+ * @date Last modified: 2026-10-20T13:18:44-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "charger.h"
+#include "queue.h"
+#include "lm75.h"
+
+#define HOST_INSTANCE(name, type) \
+  type Host##name;                \
+  HostHook_t Host##name##Hook;
+
+HOST_INSTANCE(I2C, LPC_I2C_TypeDef)
+HOST_INSTANCE(WDT, LPC_WDT_TypeDef)
+HOST_INSTANCE(UART, LPC_UART_TypeDef)
+HOST_INSTANCE(TMR16B0, LPC_TMR_TypeDef)
+HOST_INSTANCE(TMR16B1, LPC_TMR_TypeDef)
+HOST_INSTANCE(TMR32B0, LPC_TMR_TypeDef)
+HOST_INSTANCE(TMR32B1, LPC_TMR_TypeDef)
+HOST_INSTANCE(ADC, LPC_ADC_TypeDef)
+HOST_INSTANCE(PMU, LPC_PMU_TypeDef)
+HOST_INSTANCE(FLASHCTRL, LPC_FLASHCTRL_Type)
+HOST_INSTANCE(SSP0, LPC_SSP_TypeDef)
+HOST_INSTANCE(SSP1, LPC_SSP_TypeDef)
+HOST_INSTANCE(CAN, LPC_CAN_TypeDef)
+HOST_INSTANCE(IOCON, LPC_IOCON_TypeDef)
+HOST_INSTANCE(SYSCON, LPC_SYSCON_TypeDef)
+HOST_INSTANCE(GPIO0, LPC_GPIO_TypeDef)
+HOST_INSTANCE(GPIO1, LPC_GPIO_TypeDef)
+HOST_INSTANCE(GPIO2, LPC_GPIO_TypeDef)
+HOST_INSTANCE(GPIO3, LPC_GPIO_TypeDef)
+
+volatile uint32_t HostIrqEnabled;
+volatile uint32_t HostIrqPriority[32];
+volatile uint32_t HostIrqMasked;
+HostHook_t HostDispatch;
+
+uint32_t SystemCoreClock = 48000000;
+
+//
+// Defined in main.c on the target
+//
+volatile uint32_t State, Fault;
+volatile uint32_t FastVoltage, RawCurrent, RawVoltage;
+volatile int32_t Temperature = TEMP_NONE, HottestTemperature = TEMP_NONE;
+EventQueue_t SensorEvents;
@@ -0,0 +1,263 @@
+/**
+ * @file icount.c
+ *
+ * @brief Count the host instructions executed by a piece of code.
+ * @details The parent traces the child. While counting is off the child
+ * runs freely; while it is on, the child is single-stepped and the running
+ * totals are written into ICount and ICycles after every step. ICount_Start()
+ * and ICount_Stop() signal the parent with SIGUSR1, which is never
+ * delivered. The child is a fork of the parent, so ICount, ICycles and the
+ * list of excluded functions are at the same addresses in both.
+ *
+ * The cycles for each instruction are estimated from its bytes by
+ * M0Cost_Decode(), and kept in a cache by address since the code does not
+ * change. A load from the literal pool is charged the first time an
+ * instruction runs after a call or a return, and not again until the next
+ * one, since the M0 compiler keeps the value in a register round a loop
+ * that makes no calls. A call of an excluded function is followed until it
+ * returns to the address that the call pushed, and costs nothing.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T12:06:40-0400
+ * @date Last modified: 2026-10-20T14:48:13-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/types.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include "icount.h"
+#include "m0cost.h"
+
+//
+// Entries in the cache of decoded instructions, a power of two
+//
+#define CACHE_SIZE  4096
+
+volatile uint64_t ICount;
+volatile uint64_t ICycles;
+
+/*
+ * The functions excluded from the cycle estimate, set in the child and
+ * read by the parent each time counting starts
+ */
+static volatile uintptr_t Excluded[ICOUNT_MAX_EXCLUDED];
+static volatile uint32_t NumExcluded;
+
+/*
+ * Decoded instructions, by address
+ */
+typedef struct
+{
+  uintptr_t Pc;
+  M0Cost_t Cost;
+  uint64_t Paid;                // the frame in which the literal was loaded
+} Cached_t;
+
+static Cached_t Cache[CACHE_SIZE];
+
+void ICount_Start(void)
+{
+  raise(SIGUSR1);
+}
+
+void ICount_Stop(void)
+{
+  raise(SIGUSR1);
+}
+
+void ICount_Exclude(void (*fn)(void))
+{
+  uint32_t i;
+
+  if (0 == fn)
+    return;
+  for (i = 0; i < NumExcluded; i++) {
+    if (Excluded[i] == (uintptr_t) fn)
+      return;
+  }
+  if (NumExcluded < ICOUNT_MAX_EXCLUDED)
+    Excluded[NumExcluded++] = (uintptr_t) fn;
+}
+
+/*
+ * Read a word of the child's memory
+ */
+static uintptr_t Peek(pid_t pid, const volatile void *address)
+{
+  return (uintptr_t) ptrace(PTRACE_PEEKDATA, pid, (void *) address, 0);
+}
+
+/*
+ * Copy the list of excluded functions from the child
+ */
+static void ReadExcluded(pid_t pid)
+{
+  uint32_t i;
+
+  NumExcluded = (uint32_t) Peek(pid, &NumExcluded);
+  if (NumExcluded > ICOUNT_MAX_EXCLUDED)
+    NumExcluded = ICOUNT_MAX_EXCLUDED;
+  for (i = 0; i < NumExcluded; i++)
+    Excluded[i] = Peek(pid, &Excluded[i]);
+}
+
+static uint32_t IsExcluded(uintptr_t pc)
+{
+  uint32_t i;
+
+  for (i = 0; i < NumExcluded; i++) {
+    if (Excluded[i] == pc)
+      return 1;
+  }
+  return 0;
+}
+
+/*
+ * The estimate for the instruction at pc in the child
+ */
+static Cached_t *Cost(pid_t pid, uintptr_t pc)
+{
+  Cached_t *entry = &Cache[(pc ^ (pc >> 12)) & (CACHE_SIZE - 1)];
+  uintptr_t code[(M0COST_MAX_LENGTH + 1) / sizeof(uintptr_t)];
+  uint32_t i;
+
+  if (entry->Pc != pc) {
+    for (i = 0; i < sizeof(code) / sizeof(code[0]); i++)
+      code[i] = (uintptr_t) ptrace(PTRACE_PEEKTEXT, pid,
+                                   (void *) (pc + i * sizeof(code[0])), 0);
+    M0Cost_Decode((const uint8_t *) code, &entry->Cost);
+    entry->Pc = pc;
+    entry->Paid = 0;
+  }
+  return entry;
+}
+
+/*
+ * Resume the child, stepping one instruction or running to the next signal
+ */
+static int Resume(pid_t pid, int step, int sig)
+{
+  long r = ptrace(step ? PTRACE_SINGLESTEP : PTRACE_CONT, pid, 0,
+                  (void *) (long) sig);
+
+  if (r < 0)
+    perror("icount: ptrace");
+  return (int) r;
+}
+
+int ICount_Run(void (*body)(void))
+{
+  pid_t pid;
+  int status, sig, step = 0;
+  uint64_t count = 0, cycles = 0, frame = 0;
+  struct user_regs_struct regs;
+  uintptr_t pc = 0, skipTo = 0;
+  Cached_t *entry;
+  const M0Cost_t *cost;
+
+  fflush(stdout);
+  pid = fork();
+  if (pid < 0) {
+    perror("icount: fork");
+    return -1;
+  }
+  if (0 == pid) {
+    if (ptrace(PTRACE_TRACEME, 0, 0, 0) < 0) {
+      perror("icount: PTRACE_TRACEME");
+      _exit(127);
+    }
+    raise(SIGSTOP);
+    body();
+    fflush(stdout);
+    _exit(0);
+  }
+  //
+  // The child stops itself once it is traced
+  //
+  if ((waitpid(pid, &status, 0) != pid) || !WIFSTOPPED(status)) {
+    fprintf(stderr, "icount: the child could not be traced\n");
+    return -1;
+  }
+  sig = 0;
+  for (;;) {
+    if (Resume(pid, step, sig) < 0) {
+      kill(pid, SIGKILL);
+      waitpid(pid, &status, 0);
+      return -1;
+    }
+    if (waitpid(pid, &status, 0) != pid) {
+      perror("icount: waitpid");
+      return -1;
+    }
+    if (WIFEXITED(status))
+      return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) {
+      fprintf(stderr, "icount: the child was killed by signal %d\n",
+              WTERMSIG(status));
+      return -1;
+    }
+    sig = WSTOPSIG(status);
+    if ((SIGTRAP == sig) && step) {
+      count++;
+      ptrace(PTRACE_POKEDATA, pid, (void *) &ICount,
+             (void *) (uintptr_t) count);
+      ptrace(PTRACE_GETREGS, pid, 0, &regs);
+      //
+      // Charge the instruction just executed, unless it is in an excluded
+      // function or is the call of one
+      //
+      if (0 == skipTo) {
+        entry = Cost(pid, pc);
+        cost = &entry->Cost;
+        if (cost->Call && IsExcluded(regs.rip)) {
+          skipTo = Peek(pid, (void *) regs.rsp);
+        } else {
+          if ((0 != cost->Length) && (regs.rip != pc + cost->Length))
+            cycles += M0_TAKEN;
+          else if (entry->Paid == frame)
+            cycles += cost->Cycles - cost->Literal;
+          else
+            cycles += cost->Cycles;
+          entry->Paid = frame;
+          if (cost->Call || cost->Return)
+            frame++;
+          ptrace(PTRACE_POKEDATA, pid, (void *) &ICycles,
+                 (void *) (uintptr_t) cycles);
+        }
+      } else if (regs.rip == skipTo) {
+        skipTo = 0;
+      }
+      pc = regs.rip;
+      sig = 0;
+    } else if (SIGUSR1 == sig) {
+      step = !step;
+      if (step) {
+        ReadExcluded(pid);
+        ptrace(PTRACE_GETREGS, pid, 0, &regs);
+        pc = regs.rip;
+        skipTo = 0;
+        frame++;
+      }
+      sig = 0;
+    } else if ((SIGSTOP == sig) || (SIGTRAP == sig)) {
+      sig = 0;
+    }
+  }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file icount.h
+ *
+ * @brief Count the host instructions executed by a piece of code.
+ * @details The code runs in a child process that is single-stepped with
+ * ptrace while counting is on. The count is exact and does not depend on
+ * the load on the machine, so two runs of the same binary give the same
+ * numbers. They are host instructions, not LPC1114 clock cycles. Alongside
+ * the count, the Cortex-M0 cycles that the same instructions stand for are
+ * estimated with the model of m0cost.h, which is closer to the time on
+ * target. Functions that stand in for hardware, such as the hooks of the
+ * simulated peripherals, may be left out of the estimate.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T12:06:40-0400
+ * @date Last modified: 2026-10-20T13:42:06-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _ICOUNT_H_
+#  define _ICOUNT_H_
+
+#  include <stdint.h>
+
+/**
+ * @var ICount
+ * @brief Instructions counted so far, kept up to date in the child while
+ * counting is on.
+ */
+extern volatile uint64_t ICount;
+
+/**
+ * @var ICycles
+ * @brief Estimated Cortex-M0 cycles so far, kept up to date with ::ICount.
+ */
+extern volatile uint64_t ICycles;
+
+/**
+ * @def ICOUNT_MAX_EXCLUDED
+ * @brief The most functions that can be left out of the cycle estimate.
+ */
+#  define ICOUNT_MAX_EXCLUDED  8
+
+//
+// Run body in a child process, return its exit status or -1 on failure
+//
+int ICount_Run(void (*body)(void));
+//
+// Turn counting on and off, called by the child
+//
+void ICount_Start(void);
+void ICount_Stop(void);
+//
+// Leave calls of fn out of the cycle estimate, called by the child
+//
+void ICount_Exclude(void (*fn)(void));
+
+#endif
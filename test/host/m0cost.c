@@ -0,0 +1,325 @@
+/**
+ * @file m0cost.c
+ *
+ * @brief Estimate the Cortex-M0 cycles that a host instruction stands for.
+ * @details Only as much of the instruction is decoded as the cost needs:
+ * the prefixes, the opcode, whether the ModRM operand is in memory or is a
+ * global, and the immediate of the instructions that load a constant. Any
+ * instruction not recognised below costs ::M0_ALU. See m0cost.h for the
+ * model.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T13:42:06-0400
+ * @date Last modified: 2026-10-20T14:48:13-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <string.h>
+#include "m0cost.h"
+
+//
+// Opcodes of the two-byte map are 0x100 + the second byte
+//
+#define TWO_BYTE  0x100
+
+//
+// The largest constant that MOVS can make
+//
+#define MOVS_MAX  255
+
+/*
+ * The operand given by a ModRM byte
+ */
+typedef struct
+{
+  uint32_t Memory;              // the operand is in memory
+  uint32_t Global;              // ... at an address relative to the PC
+  uint32_t Reg;                 // the reg field, which extends some opcodes
+  const uint8_t *Next;          // the byte after the operand
+} Operand_t;
+
+/*
+ * Non-zero if the opcode is followed by a ModRM byte
+ */
+static uint32_t HasModRM(uint32_t op)
+{
+  if (op >= TWO_BYTE) {
+    op -= TWO_BYTE;
+    return !(((op >= 0x80) && (op <= 0x8F)) || ((op >= 0xC8) && (op <= 0xCF))
+             || ((op >= 0x05) && (op <= 0x09)) || (0x0B == op) ||
+             ((op >= 0x30) && (op <= 0x37)) || (0x77 == op) ||
+             (0xA0 == op) || (0xA1 == op) || (0xA2 == op) ||
+             (0xA8 == op) || (0xA9 == op));
+  }
+  if (op < 0x40)
+    return (op & 7) < 4;
+  return (0x62 == op) || (0x63 == op) || (0x69 == op) || (0x6B == op) ||
+    ((op >= 0x80) && (op <= 0x8F)) || (0xC0 == op) || (0xC1 == op) ||
+    (0xC6 == op) || (0xC7 == op) || ((op >= 0xD0) && (op <= 0xDF)) ||
+    (0xF6 == op) || (0xF7 == op) || (0xFE == op) || (0xFF == op);
+}
+
+/*
+ * Decode the ModRM byte at p, and the SIB byte and displacement after it
+ */
+static void Decode(const uint8_t *p, Operand_t *operand)
+{
+  uint32_t mod = *p >> 6, rm = *p & 7;
+
+  operand->Reg = (*p >> 3) & 7;
+  operand->Memory = (mod != 3);
+  operand->Global = (0 == mod) && (5 == rm);
+  p++;
+  if (operand->Memory && (4 == rm)) {
+    if ((0 == mod) && (5 == (*p & 7)))
+      p += 4;
+    p++;
+  }
+  if (1 == mod)
+    p += 1;
+  else if ((2 == mod) || operand->Global)
+    p += 4;
+  operand->Next = p;
+}
+
+/*
+ * Cycles of the instruction being decoded that load from the literal pool
+ */
+static uint32_t Literal;
+
+static uint32_t Pool(void)
+{
+  Literal += M0_LOAD;
+  return M0_LOAD;
+}
+
+/*
+ * The cycles to load a constant into a register, and the extra cycles to
+ * use it as an operand, which only MOVS, ADDS, SUBS and CMP can take
+ */
+static uint32_t Constant(int64_t value)
+{
+  return ((value >= 0) && (value <= MOVS_MAX)) ? M0_ALU : Pool();
+}
+
+static uint32_t Immediate(int64_t value)
+{
+  return ((value >= 0) && (value <= MOVS_MAX)) ? 0 : Pool();
+}
+
+static int32_t Imm32(const uint8_t *p)
+{
+  int32_t value;
+
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/*
+ * The cycles to read the operand, or to read, change and write it back
+ */
+static uint32_t Read(const Operand_t *operand)
+{
+  if (!operand->Memory)
+    return M0_ALU;
+  return M0_LOAD + M0_ALU + (operand->Global ? Pool() : 0);
+}
+
+static uint32_t Change(const Operand_t *operand)
+{
+  if (!operand->Memory)
+    return M0_ALU;
+  return Read(operand) + M0_STORE;
+}
+
+static uint32_t Store(const Operand_t *operand)
+{
+  if (!operand->Memory)
+    return M0_ALU;
+  return M0_STORE + (operand->Global ? Pool() : 0);
+}
+
+static uint32_t Load(const Operand_t *operand)
+{
+  if (!operand->Memory)
+    return M0_ALU;
+  return M0_LOAD + (operand->Global ? Pool() : 0);
+}
+
+/**
+ * @brief Estimate the cycles for one host instruction.
+ *
+ * @param[in] code the instruction, and at least enough bytes after it to
+ * make up ::M0COST_MAX_LENGTH + 1
+ * @param[out] cost the estimate
+ */
+void M0Cost_Decode(const uint8_t code[M0COST_MAX_LENGTH + 1],
+                   M0Cost_t *cost)
+{
+  const uint8_t *p = code;
+  uint32_t wide = 0, op, cycles;
+  Operand_t operand = {0, 0, 0, 0};
+
+  cost->Length = 0;
+  cost->Call = 0;
+  cost->Return = 0;
+  Literal = 0;
+  while ((0x66 == *p) || (0x67 == *p) || (0xF0 == *p) || (0xF2 == *p) ||
+         (0xF3 == *p) || (0x2E == *p) || (0x36 == *p) || (0x3E == *p) ||
+         (0x26 == *p) || (0x64 == *p) || (0x65 == *p))
+    p++;
+  if (0x40 == (*p & 0xF0))
+    wide = (*p++ & 0x08) != 0;
+  op = *p++;
+  if (0x0F == op) {
+    op = TWO_BYTE + *p++;
+    if ((TWO_BYTE + 0x38 == op) || (TWO_BYTE + 0x3A == op))
+      p++;
+  }
+  if (HasModRM(op))
+    Decode(p, &operand);
+
+  if (op < 0x40) {
+    if ((op & 7) == 5)
+      cycles = M0_ALU + Immediate(Imm32(p));
+    else if ((op & 7) == 4)
+      cycles = M0_ALU;
+    else if ((op & 2) || (0x38 == (op & 0xF8)))
+      cycles = Read(&operand);
+    else
+      cycles = Change(&operand);
+  } else if ((op >= 0x50) && (op <= 0x5F)) {
+    // PUSH and POP, a cycle for each register
+    cycles = M0_ALU;
+  } else if (0x63 == op) {
+    cycles = operand.Memory ? Load(&operand) : 0;
+  } else if ((0x68 == op) || (0x6A == op)) {
+    cycles = M0_ALU + M0_STORE;
+  } else if ((0x69 == op) || (0x6B == op)) {
+    int64_t imm = (0x69 == op) ? Imm32(operand.Next) :
+      (int8_t) *operand.Next;
+
+    if (wide && ((imm < INT16_MIN) || (imm > INT16_MAX)))
+      cycles = M0_DIVIDE;
+    else
+      cycles = Constant(imm) + Read(&operand);
+  } else if ((op >= 0x70) && (op <= 0x7F)) {
+    cycles = M0_ALU;
+    cost->Length = (uint8_t) (p + 1 - code);
+  } else if ((op >= 0x80) && (op <= 0x83)) {
+    cycles = (7 == operand.Reg) ? Read(&operand) : Change(&operand);
+    if (0x81 == op)
+      cycles += Immediate(Imm32(operand.Next));
+  } else if ((0x84 == op) || (0x85 == op)) {
+    cycles = Read(&operand);
+  } else if ((0x86 == op) || (0x87 == op)) {
+    cycles = operand.Memory ? Change(&operand) : 3 * M0_ALU;
+  } else if ((0x88 == op) || (0x89 == op)) {
+    cycles = Store(&operand);
+  } else if ((0x8A == op) || (0x8B == op)) {
+    cycles = Load(&operand);
+  } else if (0x8D == op) {
+    cycles = operand.Global ? Pool() : M0_ALU;
+  } else if (0x90 == op) {
+    cycles = 0;
+  } else if ((op >= 0x91) && (op <= 0x97)) {
+    cycles = 3 * M0_ALU;
+  } else if ((0xA4 == op) || (0xA5 == op)) {
+    cycles = M0_LOAD + M0_STORE;
+  } else if ((0xA6 == op) || (0xA7 == op)) {
+    cycles = 2 * M0_LOAD + M0_ALU;
+  } else if ((op >= 0xAA) && (op <= 0xAF)) {
+    cycles = (op >= 0xAE) ? M0_LOAD + M0_ALU : M0_LOAD;
+  } else if ((op >= 0xB8) && (op <= 0xBF)) {
+    cycles = wide ? Pool() : Constant((uint32_t) Imm32(p));
+  } else if ((0xC0 == op) || (0xC1 == op) ||
+             ((op >= 0xD0) && (op <= 0xD3))) {
+    cycles = Change(&operand);
+  } else if ((0xC2 == op) || (0xC3 == op)) {
+    cycles = M0_RETURN;
+    cost->Return = 1;
+  } else if ((0xC6 == op) || (0xC7 == op)) {
+    cycles = (0xC7 == op) ? Constant(Imm32(operand.Next)) : M0_ALU;
+    if (operand.Memory)
+      cycles += Store(&operand);
+  } else if (0xC9 == op) {
+    cycles = 2 * M0_ALU;
+  } else if (0xCC == op) {
+    cycles = 0;
+  } else if (0xE3 == op) {
+    cycles = M0_ALU;
+    cost->Length = (uint8_t) (p + 1 - code);
+  } else if (0xE8 == op) {
+    cycles = M0_CALL;
+    cost->Call = 1;
+  } else if ((0xE9 == op) || (0xEB == op)) {
+    cycles = M0_TAKEN;
+  } else if ((0xF6 == op) || (0xF7 == op)) {
+    if (operand.Reg >= 4)
+      cycles = M0_DIVIDE;
+    else if (operand.Reg >= 2)
+      cycles = Change(&operand);
+    else
+      cycles = Read(&operand) +
+        ((0xF7 == op) ? Immediate(Imm32(operand.Next)) : 0);
+  } else if ((0xFE == op) || (0xFF == op)) {
+    switch (operand.Reg) {
+      case 2:
+      case 3:
+        cycles = M0_CALL + Load(&operand) - M0_ALU;
+        cost->Call = 1;
+        break;
+      case 4:
+      case 5:
+        cycles = M0_TAKEN + Load(&operand) - M0_ALU;
+        break;
+      case 6:
+        cycles = Load(&operand) + M0_STORE;
+        break;
+      default:
+        cycles = Change(&operand);
+        break;
+    }
+  } else if (op >= TWO_BYTE) {
+    op -= TWO_BYTE;
+    if ((op >= 0x80) && (op <= 0x8F)) {
+      cycles = M0_ALU;
+      cost->Length = (uint8_t) (p + 4 - code);
+    } else if ((op >= 0x18) && (op <= 0x1F)) {
+      // hints, ENDBR64 and the long NOP
+      cycles = 0;
+    } else if ((op >= 0x40) && (op <= 0x4F)) {
+      // a branch around a move
+      cycles = M0_TAKEN + Load(&operand) - M0_ALU;
+    } else if ((op >= 0x90) && (op <= 0x9F)) {
+      cycles = M0_TAKEN + (operand.Memory ? Store(&operand) : 0);
+    } else if (0xAF == op) {
+      cycles = wide ? M0_DIVIDE : Read(&operand);
+    } else if ((0xB6 == op) || (0xB7 == op) || (0xBE == op) ||
+               (0xBF == op)) {
+      cycles = Load(&operand);
+    } else if ((0xA4 == op) || (0xA5 == op) || (0xAC == op) ||
+               (0xAD == op)) {
+      cycles = 3 * M0_ALU;
+    } else if (operand.Memory) {
+      cycles = M0_BLOCK + (operand.Global ? Pool() : 0);
+    } else {
+      cycles = M0_ALU;
+    }
+  } else {
+    cycles = M0_ALU;
+  }
+  cost->Cycles = (uint8_t) cycles;
+  cost->Literal = (uint8_t) Literal;
+}
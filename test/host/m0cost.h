@@ -0,0 +1,89 @@
+/**
+ * @file m0cost.h
+ *
+ * @brief Estimate the Cortex-M0 cycles that a host instruction stands for.
+ * @details Each x86-64 instruction is costed as the Thumb instructions that
+ * do the same work on the LPC1114, with the cycle counts of the Cortex-M0
+ * Technical Reference Manual and no flash wait states:
+ * - an operation between registers is 1 cycle, and so is MULS;
+ * - a load or a store is 2, and a register-memory operation is a load, the
+ *   operation and, unless it is a compare, a store;
+ * - a global variable, or a constant that MOVS cannot make, is first loaded
+ *   from the literal pool, 2 more cycles. The share of these in the cost is
+ *   kept apart, so that the load need only be charged once in each call of
+ *   a function, as the compiler keeps such a value in a register round a
+ *   loop;
+ * - a branch is 1 cycle if it is not taken and 3 if it is, BL and a return
+ *   are 4;
+ * - a 16-byte move is an LDM or STM of four registers, 5 cycles;
+ * - a divide, and a multiply whose product needs more than 32 bits, is a
+ *   call of the library divide routine, taken as ::M0_DIVIDE cycles. The
+ *   host compiler uses the wide multiply to divide by a constant, which the
+ *   M0 compiler does with the library routine;
+ * - padding and sign extension to 64 bits cost nothing.
+ *
+ * The estimate does not account for the M0 having eight low registers
+ * where the host has sixteen, nor for the Thumb compiler making different
+ * choices. It is good for comparing paths and for seeing how a change moves
+ * them, and to within a few tens of percent for the time on target.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T13:42:06-0400
+ * @date Last modified: 2026-10-20T14:48:13-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _M0COST_H_
+#  define _M0COST_H_
+
+#  include <stdint.h>
+
+/**
+ * @name Cortex-M0 cycle costs
+ */
+/**@{*/
+#  define M0_ALU     1          ///< Data processing, MOVS, MULS
+#  define M0_LOAD    2          ///< LDR, including from the literal pool
+#  define M0_STORE   2          ///< STR
+#  define M0_TAKEN   3          ///< B that is taken, or BX
+#  define M0_CALL    4          ///< BL
+#  define M0_RETURN  4          ///< POP {PC}, beyond the registers popped
+#  define M0_BLOCK   5          ///< LDM or STM of four registers
+#  define M0_DIVIDE  50         ///< __aeabi_uidiv, it varies with the operands
+/**@}*/
+
+/**
+ * @brief The longest x86-64 instruction, in bytes.
+ */
+#  define M0COST_MAX_LENGTH  15
+
+/**
+ * @brief The estimate for one host instruction.
+ */
+typedef struct
+{
+  uint8_t Cycles;               ///< Cycles, or when not taken for a branch
+  uint8_t Length;               ///< Length of a conditional branch, else 0
+  uint8_t Call;                 ///< Non-zero for a call
+  uint8_t Return;               ///< Non-zero for a return
+  uint8_t Literal;              ///< Cycles of those loading a literal
+} M0Cost_t;
+
+//
+// Estimate the cycles for the instruction whose bytes are in code
+//
+void M0Cost_Decode(const uint8_t code[M0COST_MAX_LENGTH + 1],
+                   M0Cost_t *cost);
+
+#endif
@@ -0,0 +1,27 @@
+/**
+ * @file ticks.c
+ *
+ * @brief The tick counters, for tests that do not link SysTick.c.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:06:40-0400
+ * @date Last modified: 2026-10-20T11:06:40-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include "LPC11xx.h"
+#include "SysTick.h"
+
+volatile uint32_t Ticks;
+volatile uint32_t TickCount;
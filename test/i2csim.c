@@ -0,0 +1,363 @@
+/**
+ * @file i2csim.c
+ *
+ * @brief Host simulation of the LPC1114 I2C controller and LM75 sensors.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:14:03-0400
+ * @date Last modified: 2026-10-20T11:14:03-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "LPC11xx.h"
+#include "i2c.h"
+#include "i2csim.h"
+
+I2CSim_t I2CSim;
+LM75Model_t I2CSimDevices[I2CSIM_MAX_DEVICES];
+
+static const uint32_t SCL_PIN = 1uL << 4;
+static const uint32_t SDA_PIN = 1uL << 5;
+/* Written to the cell for both pins so that any real write shows up */
+static const uint32_t NOT_WRITTEN = 0xFFFFFFFFuL;
+
+static uint32_t Control;                 /* The real CONSET contents */
+static uint32_t Status = 0xF8;           /* The real STAT contents */
+static uint32_t Owned;                   /* We are the bus master */
+static LM75Model_t *Selected;            /* The device addressed, if any */
+static uint32_t InHandler;
+static uint32_t LastScl = 1, LastSda = 1;
+static uint32_t SdaLatch, SdaShown;      /* Output latch, and line level */
+static char Trace[4096];
+static size_t TraceLength;
+static char TraceCopy[sizeof(Trace)];
+
+static void Log(const char *fmt, uint32_t value, char ack)
+{
+  int n;
+
+  if (TraceLength >= sizeof(Trace) - 16)
+    return;
+  n = snprintf(Trace + TraceLength, sizeof(Trace) - TraceLength, "%s",
+               (0 == TraceLength) ? "" : " ");
+  TraceLength += n;
+  n = snprintf(Trace + TraceLength, sizeof(Trace) - TraceLength, fmt, value,
+               ack);
+  TraceLength += n;
+}
+
+/*
+ * Time on the bus for a number of SCL periods, at the rate set by SCLH and
+ * SCLL. A start or stop condition is counted as one period.
+ */
+static void Clock(uint32_t periods)
+{
+  I2CSim.BusCycles += (uint64_t) periods * (HostI2C.SCLH + HostI2C.SCLL);
+}
+
+static LM75Model_t *Find(uint8_t address)
+{
+  uint32_t i;
+
+  for (i = 0; i < I2CSIM_MAX_DEVICES; i++) {
+    if (I2CSimDevices[i].Present &&
+        (I2CSimDevices[i].Address == (address & ~RD_BIT)))
+      return &I2CSimDevices[i];
+  }
+  return 0;
+}
+
+/*
+ * The configuration register is 8 bits, the others are 16
+ */
+static uint32_t RegisterBytes(uint8_t pointer)
+{
+  return (1 == pointer) ? 1 : 2;
+}
+
+static uint8_t DeviceRead(LM75Model_t *d)
+{
+  uint32_t p = d->Pointer & 3;
+  uint32_t i = d->Index++ % RegisterBytes(p);
+
+  return (0 == i) ? (d->Reg[p] >> 8) : (d->Reg[p] & 0xFF);
+}
+
+static void DeviceWrite(LM75Model_t *d, uint8_t value)
+{
+  uint32_t p;
+
+  if (0 == d->Index++) {
+    d->Pointer = value & 3;
+  } else {
+    p = d->Pointer;
+    if (2 == d->Index)
+      d->Reg[p] = (uint16_t) (value << 8);
+    else
+      d->Reg[p] |= value;
+  }
+}
+
+/*
+ * Move the bus one step after SI has been cleared, as the controller would,
+ * and set SI again when there is a new status.
+ */
+static void Act(void)
+{
+  uint32_t value;
+  uint32_t ack;
+
+  if (!(Control & I2CONSET_I2EN) || (Control & I2CONSET_SI))
+    return;
+  if (0 != I2CSim.StuckClocks)
+    return;                     /* SDA is held low, nothing can move */
+  if (Control & I2CONSET_STO) {
+    Control &= ~I2CONSET_STO;
+    if (Owned) {
+      Log("P", 0, 0);
+      Clock(1);
+      I2CSim.Stops++;
+      Owned = 0;
+      Selected = 0;
+      Status = 0xF8;
+    }
+  }
+  if (Control & I2CONSET_STA) {
+    Log(Owned ? "Sr" : "S", 0, 0);
+    Clock(1);
+    I2CSim.Starts++;
+    Status = Owned ? 0x10 : 0x08;
+    Owned = 1;
+    Selected = 0;
+    Control |= I2CONSET_SI;
+    return;
+  }
+  if (!Owned)
+    return;
+  switch (Status) {
+  case 0x08:
+  case 0x10:
+    value = HostI2C.DAT & 0xFF;
+    Clock(9);
+    I2CSim.Bytes++;
+    if (0 != I2CSim.LoseArbitration) {
+      I2CSim.LoseArbitration--;
+      Log("%02X!", value, 0);
+      Owned = 0;
+      Status = 0x38;
+      break;
+    }
+    Selected = Find(value);
+    ack = (0 != Selected);
+    Log("%02X%c", value, ack ? '+' : '-');
+    if (ack) {
+      Selected->Index = 0;
+      if (value & RD_BIT)
+        Selected->Reads++;
+      else
+        Selected->Writes++;
+    }
+    if (value & RD_BIT)
+      Status = ack ? 0x40 : 0x48;
+    else
+      Status = ack ? 0x18 : 0x20;
+    break;
+
+  case 0x18:
+  case 0x28:
+    value = HostI2C.DAT & 0xFF;
+    Clock(9);
+    I2CSim.Bytes++;
+    ack = !Selected->NackData;
+    if (ack)
+      DeviceWrite(Selected, value);
+    Log("%02X%c", value, ack ? '+' : '-');
+    Status = ack ? 0x28 : 0x30;
+    break;
+
+  case 0x40:
+  case 0x50:
+    value = DeviceRead(Selected);
+    HostI2C.DAT = value;
+    Clock(9);
+    I2CSim.Bytes++;
+    ack = (Control & I2CONSET_AA);
+    Log("%02X%c", value, ack ? '+' : '-');
+    Status = ack ? 0x50 : 0x58;
+    break;
+
+  default:
+    return;                     /* Waiting for a start or stop */
+  }
+  Control |= I2CONSET_SI;
+}
+
+/*
+ * Called before every access to the I2C registers. A write to CONSET shows
+ * up as a change from the real contents, and a write to CONCLR as a non-zero
+ * value, because only one access can have happened since the last call.
+ */
+static void Sync(void)
+{
+  if (HostI2C.CONSET != Control)
+    Control |= HostI2C.CONSET;
+  if (0 != HostI2C.CONCLR) {
+    Control &= ~HostI2C.CONCLR;
+    HostI2C.CONCLR = 0;
+  }
+  if (!(Control & I2CONSET_I2EN)) {
+    Owned = 0;
+    Selected = 0;
+    Status = 0xF8;
+    Control = 0;
+  }
+  Act();
+  HostI2C.CONSET = Control;
+  *(volatile uint32_t *) &HostI2C.STAT = Status;
+}
+
+/*
+ * Called before every access to port 0. While the I2C pins are GPIO, count
+ * the pulses on SCL, release the stuck slave after enough of them, and see
+ * a stop condition made by hand. A write to the SDA cell shows up as a change
+ * from the line level last shown there, and sets the output latch.
+ */
+static void GpioSync(void)
+{
+  volatile uint32_t *pin = HostGPIO0.MASKED_ACCESS;
+  uint32_t scl, sda;
+
+  if (NOT_WRITTEN != pin[SCL_PIN | SDA_PIN]) {
+    pin[SCL_PIN] = pin[SCL_PIN | SDA_PIN] & SCL_PIN;
+    SdaLatch = pin[SCL_PIN | SDA_PIN] & SDA_PIN;
+    pin[SCL_PIN | SDA_PIN] = NOT_WRITTEN;
+  } else if (pin[SDA_PIN] != SdaShown) {
+    SdaLatch = pin[SDA_PIN];
+  }
+  if ((0 != HostIOCON.PIO0_4) || (0 != HostIOCON.PIO0_5))
+    return;                     /* The controller has the pins */
+  scl = !(HostGPIO0.DIR & SCL_PIN) || (0 != pin[SCL_PIN]);
+  if (scl && !LastScl) {
+    I2CSim.GpioClocks++;
+    if (0 != I2CSim.StuckClocks)
+      I2CSim.StuckClocks--;
+  }
+  sda = (0 == I2CSim.StuckClocks) &&
+      (!(HostGPIO0.DIR & SDA_PIN) || (0 != SdaLatch));
+  SdaShown = sda ? SDA_PIN : 0;
+  pin[SDA_PIN] = SdaShown;
+  if (sda && !LastSda && scl && (HostGPIO0.DIR & SDA_PIN)) {
+    Log("P", 0, 0);
+    I2CSim.GpioStops++;
+  }
+  LastScl = scl;
+  LastSda = sda;
+}
+
+/*
+ * Run the handler while the controller wants service and the interrupt is
+ * enabled. The handler itself may enable the interrupt again, so this must
+ * not nest.
+ */
+static void Dispatch(void)
+{
+  if (I2CSim.Paused)
+    return;
+  I2CSim_Run();
+}
+
+void I2CSim_Run(void)
+{
+  if (InHandler)
+    return;
+  Sync();
+  while ((Control & I2CONSET_SI) && (HostIrqEnabled & (1uL << I2C_IRQn)) &&
+         !HostIrqMasked) {
+    I2CSim_Step();
+  }
+}
+
+uint32_t I2CSim_Step(void)
+{
+  uint32_t status;
+
+  if (InHandler)
+    return 0;
+  Sync();
+  if (!(Control & I2CONSET_SI))
+    return 0;
+  status = Status;
+  InHandler = 1;
+  I2CSim.Interrupts++;
+  I2C_IRQHandler();
+  InHandler = 0;
+  Sync();
+  return status;
+}
+
+void I2CSim_Init(void)
+{
+  memset(&I2CSim, 0, sizeof(I2CSim));
+  memset(I2CSimDevices, 0, sizeof(I2CSimDevices));
+  memset(&HostI2C, 0, sizeof(HostI2C));
+  Control = 0;
+  Status = 0xF8;
+  Owned = 0;
+  Selected = 0;
+  InHandler = 0;
+  LastScl = 1;
+  LastSda = 1;
+  HostGPIO0.MASKED_ACCESS[SCL_PIN | SDA_PIN] = NOT_WRITTEN;
+  HostGPIO0.MASKED_ACCESS[SDA_PIN] = SDA_PIN;
+  SdaLatch = SDA_PIN;
+  SdaShown = SDA_PIN;
+  HostI2CHook = Sync;
+  HostGPIO0Hook = GpioSync;
+  HostDispatch = Dispatch;
+  TraceLength = 0;
+  Trace[0] = '\0';
+}
+
+LM75Model_t *I2CSim_AddLM75(uint8_t address, int32_t temperature)
+{
+  uint32_t i;
+
+  for (i = 0; i < I2CSIM_MAX_DEVICES; i++) {
+    if (0 == I2CSimDevices[i].Address) {
+      I2CSimDevices[i].Address = address;
+      I2CSimDevices[i].Present = 1;
+      I2CSimDevices[i].Reg[2] = 75 << 8;        /* Power-up THYST */
+      I2CSimDevices[i].Reg[3] = 80 << 8;        /* Power-up TOS */
+      I2CSim_SetTemperature(&I2CSimDevices[i], temperature);
+      return &I2CSimDevices[i];
+    }
+  }
+  return 0;
+}
+
+void I2CSim_SetTemperature(LM75Model_t *device, int32_t temperature)
+{
+  /* Two's complement, nine bits kept as on the original LM75 */
+  device->Reg[0] = (uint16_t) temperature & 0xFF80;
+}
+
+const char *I2CSim_Trace(void)
+{
+  memcpy(TraceCopy, Trace, TraceLength + 1);
+  TraceLength = 0;
+  Trace[0] = '\0';
+  return TraceCopy;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file i2csim.h
+ *
+ * @brief Host simulation of the LPC1114 I2C controller and LM75 sensors.
+ * @details The simulator watches the controller registers through the host
+ * peripheral hooks, and moves the bus one step each time the firmware clears
+ * SI, setting the status code that the real controller would. Every start,
+ * byte, acknowledge and stop is written to a text trace, so a test can check
+ * the exact sequence on the bus. Faults can be injected: a missing sensor,
+ * a sensor that NACKs data, loss of arbitration, and a slave that holds SDA
+ * low until SCL is clocked.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:14:03-0400
+ * @date Last modified: 2026-10-20T11:14:03-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#ifndef _I2CSIM_H_
+#  define _I2CSIM_H_
+
+#  include <stdint.h>
+
+/**
+ * @def I2CSIM_MAX_DEVICES
+ * @brief Number of sensor models on the simulated bus, max.
+ */
+#  define I2CSIM_MAX_DEVICES  8
+
+/**
+ * @brief A simulated LM75 temperature sensor.
+ * @details Reg holds the temperature, configuration, hysteresis and
+ * overtemperature registers, left-justified as on the bus. The first byte
+ * written selects the register, and reads start at that register.
+ */
+typedef struct
+{
+  uint8_t Address;        ///< 8-bit I2C address
+  uint8_t Present;        ///< Zero to NACK the address
+  uint8_t NackData;       ///< Non-zero to NACK every byte written
+  uint8_t Pointer;        ///< Selected register
+  uint16_t Reg[4];        ///< Register contents
+  uint32_t Index;         ///< Bytes moved since the address
+  uint32_t Reads;         ///< Number of times addressed for reading
+  uint32_t Writes;        ///< Number of times addressed for writing
+} LM75Model_t;
+
+/**
+ * @brief State of the simulated bus, and counters for the tests.
+ */
+typedef struct
+{
+  uint32_t Paused;        ///< Non-zero to run the handler only from Step
+  uint32_t LoseArbitration; ///< Number of address bytes to lose
+  uint32_t StuckClocks;   ///< SCL pulses before the stuck slave lets go
+  uint32_t Starts;        ///< Start and repeated start conditions
+  uint32_t Stops;         ///< Stop conditions sent by the controller
+  uint32_t GpioStops;     ///< Stop conditions sent with the pins as GPIO
+  uint32_t GpioClocks;    ///< SCL pulses sent with the pins as GPIO
+  uint32_t Bytes;         ///< Bytes moved, including addresses
+  uint32_t Interrupts;    ///< Calls to I2C_IRQHandler()
+  uint64_t BusCycles;     ///< Bus time, in system clocks
+} I2CSim_t;
+
+extern I2CSim_t I2CSim;
+extern LM75Model_t I2CSimDevices[I2CSIM_MAX_DEVICES];
+
+//
+// Reset the bus, remove every device, and install the register hooks
+//
+void I2CSim_Init(void);
+//
+// Put an LM75 on the bus at an 8-bit address, reading a temperature
+//
+LM75Model_t *I2CSim_AddLM75(uint8_t address, int32_t temperature);
+//
+// Set the temperature of a sensor, in 1/256 degree C
+//
+void I2CSim_SetTemperature(LM75Model_t *device, int32_t temperature);
+//
+// Run the interrupt handler while it is due, even when paused
+//
+void I2CSim_Run(void);
+//
+// Run the interrupt handler once if it is due, return the status it saw
+//
+uint32_t I2CSim_Step(void);
+//
+// Return the bus trace since the last call, and clear it
+//
+const char *I2CSim_Trace(void);
+
+#endif
@@ -0,0 +1,405 @@
+/**
+ * @file test_i2c.c
+ *
+ * @brief Tests of the I2C driver and the LM75 sensor code on the host.
+ * @details The driver runs against the simulated controller in i2csim.c,
+ * with LM75 models on the bus. Each test checks the exact bus traffic, the
+ * status the transaction ends with, and what the sensor code makes of it.
+ * The last test reports the throughput of sensor reads at I2C_SPEED_HZ.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:21:47-0400
+ * @date Last modified: 2026-10-20T11:21:47-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <stdio.h>
+#include "LPC11xx.h"
+#include "SysTick.h"
+#include "charger.h"
+#include "i2c.h"
+#include "lm75.h"
+#include "queue.h"
+#include "i2csim.h"
+#include "check.h"
+
+#define DEGREES(t)  ((int32_t) ((t) * (1 << TEMP_FRAC_BITS)))
+
+static LM75Model_t *Ambient, *Battery;
+static uint32_t CallbackCount;
+
+static void Callback(I2CTransaction *t)
+{
+  (void) t;
+  CallbackCount++;
+}
+
+/*
+ * A fresh bus with two sensors, 0x90 for ambient and 0x9E on the battery
+ */
+static void Setup(void)
+{
+  uint32_t i;
+
+  I2CSim_Init();
+  Ambient = I2CSim_AddLM75(0x90, DEGREES(25.5));
+  Battery = I2CSim_AddLM75(LM75_BATTERY_ADDR, DEGREES(30));
+  TickCount = 0;
+  Queue_Init(&SensorEvents);
+  for (i = 0; i <= I2C_OK; i++)
+    I2CStatusCount[i] = 0;
+  I2CBusRecoveries = 0;
+  CallbackCount = 0;
+  I2CInit(I2CMASTER);
+}
+
+static void Read(I2CTransaction *t, uint8_t address)
+{
+  t->Address = address;
+  t->WriteLength = 0;
+  t->ReadLength = 2;
+  t->Callback = Callback;
+}
+
+static void TestScan(void)
+{
+  Setup();
+  CHECK_EQ(LM75_Init(), 2);
+  CHECK_STR(I2CSim_Trace(),
+            "S 91+ 19+ 80- P S 93- P S 95- P S 97- P S 99- P S 9B- P "
+            "S 9D- P S 9F+ 1E+ 00- P");
+  CHECK_EQ(LM75SensorCount, 2);
+  CHECK_EQ(LM75Sensors[0].Address, 0x90);
+  CHECK_EQ(LM75Sensors[1].Address, LM75_BATTERY_ADDR);
+  CHECK_EQ(LM75BatterySensor, 1);
+  CHECK_EQ(I2CStatusCount[I2C_OK], 2);
+  CHECK_EQ(I2CStatusCount[I2C_NACK_ON_ADDRESS], 6);
+  // The sensor registers were only read, never written
+  CHECK_EQ(Ambient->Writes, 0);
+  CHECK_EQ(Battery->Writes, 0);
+  // SCL is never faster than asked for
+  CHECK(SystemCoreClock / (HostI2C.SCLH + HostI2C.SCLL) <= I2C_SPEED_HZ);
+}
+
+static void TestPoll(void)
+{
+  Event_t event;
+
+  Setup();
+  LM75_Init();
+  I2CSim_Trace();
+
+  // The first read is due at once, and reads the first sensor
+  LM75_Poll();
+  CHECK_STR(I2CSim_Trace(), "S 91+ 19+ 80- P");
+  CHECK(Queue_Get(&SensorEvents, &event));
+  CHECK_EQ(event.Type, EVENT_TEMPERATURE);
+  CHECK_EQ(event.Value, DEGREES(25.5));
+
+  // Nothing more until TEMP_READ_TICKS have passed
+  TickCount += TEMP_READ_TICKS - 1;
+  LM75_Poll();
+  CHECK_STR(I2CSim_Trace(), "");
+  CHECK(!Queue_Get(&SensorEvents, &event));
+
+  // Then the next sensor, below zero this time
+  I2CSim_SetTemperature(Battery, DEGREES(-25.5));
+  TickCount += 1;
+  LM75_Poll();
+  CHECK_STR(I2CSim_Trace(), "S 9F+ E6+ 80- P");
+  CHECK(Queue_Get(&SensorEvents, &event));
+  CHECK_EQ(event.Type, EVENT_TEMPERATURE + 1);
+  CHECK_EQ(event.Value, DEGREES(-25.5));
+
+  // The LM75 keeps only half degrees
+  I2CSim_SetTemperature(Ambient, DEGREES(-0.75));
+  TickCount += TEMP_READ_TICKS;
+  LM75_Poll();
+  CHECK_STR(I2CSim_Trace(), "S 91+ FF+ 00- P");
+  CHECK(Queue_Get(&SensorEvents, &event));
+  CHECK_EQ(event.Value, DEGREES(-1));
+}
+
+/*
+ * Process the events as the SysTick handler does, for some number of ticks
+ */
+static void RunSensors(uint32_t ticks)
+{
+  Event_t event;
+
+  while (ticks-- > 0) {
+    TickCount++;
+    LM75_Poll();
+    while (Queue_Get(&SensorEvents, &event))
+      LM75_Filter(event.Type - EVENT_TEMPERATURE, event.Value);
+    LM75_Expire();
+  }
+}
+
+static void TestLostSensor(void)
+{
+  uint32_t limit;
+
+  Setup();
+  LM75_Init();
+  RunSensors(2 * TEMP_READ_TICKS);
+  CHECK(LM75Sensors[1].Valid);
+  CHECK_EQ(LM75_Hottest(), DEGREES(30));
+  I2CSim_Trace();
+
+  // A sensor that stops answering NACKs its address, and no event is sent
+  Battery->Present = 0;
+  RunSensors(2 * TEMP_READ_TICKS);
+  CHECK_STR(I2CSim_Trace(), "S 91+ 19+ 80- P S 9F- P");
+  CHECK_EQ(LM75Sensors[1].Errors, 1);
+  CHECK_EQ(I2CStatusCount[I2C_NACK_ON_ADDRESS], 7);
+  CHECK(LM75Sensors[1].Valid);
+
+  // After TEMP_MISSED_READS reads it is lost, and no longer the hottest
+  limit = TEMP_MISSED_READS * TEMP_READ_TICKS * LM75SensorCount;
+  RunSensors(LM75Sensors[1].LastReadTick + limit - TickCount);
+  CHECK(!LM75Sensors[1].Lost);
+  RunSensors(1);
+  CHECK(LM75Sensors[1].Lost);
+  CHECK(!LM75Sensors[1].Valid);
+  CHECK(!LM75Sensors[0].Lost);
+  CHECK_EQ(LM75_Hottest(), DEGREES(25.5));
+
+  // Its next good reading restarts the filter at that reading
+  Battery->Present = 1;
+  I2CSim_SetTemperature(Battery, DEGREES(40));
+  RunSensors(2 * TEMP_READ_TICKS);
+  CHECK(!LM75Sensors[1].Lost);
+  CHECK(LM75Sensors[1].Valid);
+  CHECK_EQ(LM75Sensors[1].Temperature, DEGREES(40));
+  CHECK_EQ(LM75_Hottest(), DEGREES(40));
+}
+
+static void TestEngine(void)
+{
+  Setup();
+
+  // Write the overtemperature register
+  I2CMasterBuffer[0] = 0x90;
+  I2CMasterBuffer[1] = 3;
+  I2CMasterBuffer[2] = 0x50;
+  I2CMasterBuffer[3] = 0x00;
+  I2CWriteLength = 4;
+  I2CReadLength = 0;
+  CHECK_EQ(I2CEngine(), I2C_OK);
+  CHECK_STR(I2CSim_Trace(), "S 90+ 03+ 50+ 00+ P");
+  CHECK_EQ(Ambient->Reg[3], 0x5000);
+
+  // Read it back, with a repeated start after the pointer
+  I2CWriteLength = 2;
+  I2CReadLength = 2;
+  CHECK_EQ(I2CEngine(), I2C_OK);
+  CHECK_STR(I2CSim_Trace(), "S 90+ 03+ Sr 91+ 50+ 00- P");
+  CHECK_EQ(I2CSlaveBuffer[0], 0x50);
+  CHECK_EQ(I2CSlaveBuffer[1], 0x00);
+
+  // A sensor that refuses the data byte
+  Ambient->NackData = 1;
+  CHECK_EQ(I2CEngine(), I2C_NACK_ON_DATA);
+  CHECK_STR(I2CSim_Trace(), "S 90+ 03- P");
+  CHECK_EQ(I2CStatusCount[I2C_NACK_ON_DATA], 1);
+
+  // No sensor at all
+  I2CMasterBuffer[0] = 0x92;
+  CHECK_EQ(I2CEngine(), I2C_NACK_ON_ADDRESS);
+  CHECK_STR(I2CSim_Trace(), "S 92- P");
+  CHECK_EQ(I2CStatusCount[I2C_OK], 2);
+}
+
+static void TestQueue(void)
+{
+  const uint32_t n = I2C_QUEUE_SIZE + 1;
+  I2CTransaction t[I2C_QUEUE_SIZE + 2];
+  uint32_t i;
+
+  Setup();
+  I2CSim.Paused = 1;
+
+  // One transaction in progress, and I2C_QUEUE_SIZE waiting
+  for (i = 0; i < n; i++) {
+    Read(&t[i], (i & 1) ? LM75_BATTERY_ADDR : 0x90);
+    CHECK(I2CSubmit(&t[i]));
+  }
+  Read(&t[n], 0x90);
+  CHECK(!I2CSubmit(&t[n]));
+
+  // Nothing has moved yet, then the first start is answered
+  CHECK_EQ(t[0].Status, I2C_BUSY);
+  CHECK_EQ(I2CSim_Step(), 0x08);
+  CHECK_EQ(I2CSim_Step(), 0x40);
+  CHECK_EQ(I2CSim_Step(), 0x50);
+  CHECK_EQ(t[0].Status, I2C_BUSY);
+  CHECK_EQ(I2CSim_Step(), 0x58);
+  CHECK_EQ(t[0].Status, I2C_OK);
+  CHECK_EQ(CallbackCount, 1);
+
+  // There is room again, but not for a read longer than the buffer
+  t[n].ReadLength = BUFSIZE + 1;
+  CHECK(!I2CSubmit(&t[n]));
+
+  // The rest follow one another, each after the stop of the last
+  I2CSim_Run();
+  CHECK_STR(I2CSim_Trace(),
+            "S 91+ 19+ 80- P S 9F+ 1E+ 00- P S 91+ 19+ 80- P "
+            "S 9F+ 1E+ 00- P S 91+ 19+ 80- P");
+  for (i = 0; i < n; i++)
+    CHECK_EQ(t[i].Status, I2C_OK);
+  CHECK_EQ(t[3].ReadData[0], 0x1E);
+  CHECK_EQ(CallbackCount, n);
+  CHECK_EQ(I2CSim.Interrupts, 4 * n);
+}
+
+static void TestArbitration(void)
+{
+  I2CTransaction a, b;
+
+  Setup();
+
+  // The transaction that loses is ended, and the next one still starts
+  I2CSim.Paused = 1;
+  I2CSim.LoseArbitration = 1;
+  Read(&a, 0x90);
+  Read(&b, LM75_BATTERY_ADDR);
+  CHECK(I2CSubmit(&a));
+  CHECK(I2CSubmit(&b));
+  I2CSim_Run();
+  CHECK_STR(I2CSim_Trace(), "S 91! S 9F+ 1E+ 00- P");
+  CHECK_EQ(a.Status, I2C_ARBITRATION_LOST);
+  CHECK_EQ(b.Status, I2C_OK);
+  CHECK_EQ(I2CStatusCount[I2C_ARBITRATION_LOST], 1);
+
+  // And the sensor code simply retries on its next turn
+  I2CSim.Paused = 0;
+  LM75_Init();
+  I2CSim_Trace();
+  I2CSim.LoseArbitration = 1;
+  LM75_Poll();
+  CHECK_STR(I2CSim_Trace(), "S 91!");
+  CHECK_EQ(LM75Sensors[0].Errors, 1);
+  TickCount += TEMP_READ_TICKS;
+  LM75_Poll();
+  CHECK_STR(I2CSim_Trace(), "S 9F+ 1E+ 00- P");
+}
+
+static void TestStuckBus(void)
+{
+  I2CTransaction t, u;
+
+  Setup();
+  I2CSim.Paused = 1;
+  Read(&t, 0x90);
+  CHECK(I2CSubmit(&t));
+  CHECK_EQ(I2CSim_Step(), 0x08);
+
+  // The sensor now holds SDA low for three clocks and the bus stops
+  I2CSim.StuckClocks = 3;
+  CHECK_EQ(I2CSim_Step(), 0x40);
+  CHECK_EQ(I2CSim_Step(), 0);
+  CHECK_EQ(t.Status, I2C_BUSY);
+
+  // Not abandoned until the timeout has passed
+  TickCount += (I2C_TIMEOUT_MS * TICKS_PER_SEC + 999) / 1000;
+  CHECK(I2CCheckTimeout());
+  CHECK_EQ(t.Status, I2C_BUSY);
+  TickCount += 2;
+  CHECK(!I2CCheckTimeout());
+  CHECK_EQ(t.Status, I2C_TIME_OUT);
+  CHECK_EQ(CallbackCount, 1);
+  CHECK_EQ(I2CBusRecoveries, 1);
+
+  // SCL was clocked until SDA was free, then a stop was sent by hand,
+  // which takes one more pulse
+  CHECK_EQ(I2CSim.GpioClocks, 3 + 1);
+  CHECK_EQ(I2CSim.GpioStops, 1);
+  CHECK_EQ(I2CSim.StuckClocks, 0);
+  CHECK_EQ(HostIOCON.PIO0_4, 0x01);
+  CHECK_EQ(HostIOCON.PIO0_5, 0x01);
+  CHECK_STR(I2CSim_Trace(), "S 91+ P");
+
+  // The controller works again, and the interrupt is still enabled
+  CHECK(HostIrqEnabled & (1uL << I2C_IRQn));
+  I2CSim.Paused = 0;
+  Read(&u, LM75_BATTERY_ADDR);
+  CHECK(I2CSubmit(&u));
+  CHECK_EQ(u.Status, I2C_OK);
+  CHECK_STR(I2CSim_Trace(), "S 9F+ 1E+ 00- P");
+
+  // A slave that never lets go costs one timeout per transaction, no more
+  I2CSim.StuckClocks = 100;
+  Read(&t, 0x90);
+  CHECK(I2CSubmit(&t));
+  CHECK_EQ(t.Status, I2C_BUSY);
+  TickCount += 10;
+  CHECK(!I2CCheckTimeout());
+  CHECK_EQ(t.Status, I2C_TIME_OUT);
+  CHECK_EQ(I2CSim.GpioClocks, 3 + 1 + 9 + 1);
+  CHECK_EQ(I2CSim.GpioStops, 1);
+  CHECK_EQ(I2CBusRecoveries, 2);
+  I2CSim.StuckClocks = 0;
+  CHECK(I2CSubmit(&t));
+  CHECK_EQ(t.Status, I2C_OK);
+  CHECK_STR(I2CSim_Trace(), "S 91+ 19+ 80- P");
+}
+
+/*
+ * Bus time of sensor reads at I2C_SPEED_HZ. This leaves out the time from
+ * SI being set to the handler clearing it, which is in the WCET table.
+ */
+static void TestThroughput(void)
+{
+  const uint32_t reads = 1000;
+  uint32_t i, bytes;
+  double seconds;
+
+  Setup();
+  LM75_Init();
+  I2CSim.BusCycles = 0;
+  I2CSim.Interrupts = 0;
+  bytes = I2CByteCount;
+  for (i = 0; i < reads; i++) {
+    TickCount += TEMP_READ_TICKS;
+    LM75_Poll();
+  }
+  bytes = I2CByteCount - bytes;
+  seconds = (double) I2CSim.BusCycles / SystemCoreClock;
+  CHECK_EQ(bytes, 2 * reads);
+  CHECK_EQ(I2CSim.Interrupts, 4 * reads);
+  // Start, address, two bytes and stop take 29 SCL periods
+  CHECK_EQ(I2CSim.BusCycles,
+           (uint64_t) 29 * reads * (HostI2C.SCLH + HostI2C.SCLL));
+  printf("I2C at %u Hz, SCLH %u SCLL %u: %.1f us per sensor read, "
+         "%.0f reads/s, %.0f data bytes/s, %u interrupts per read\n",
+         (unsigned) (SystemCoreClock / (HostI2C.SCLH + HostI2C.SCLL)),
+         (unsigned) HostI2C.SCLH, (unsigned) HostI2C.SCLL,
+         1e6 * seconds / reads, reads / seconds, bytes / seconds,
+         (unsigned) (I2CSim.Interrupts / reads));
+}
+
+int main(void)
+{
+  TestScan();
+  TestPoll();
+  TestLostSensor();
+  TestEngine();
+  TestQueue();
+  TestArbitration();
+  TestStuckBus();
+  TestThroughput();
+  return CheckSummary("test_i2c");
+}
@@ -0,0 +1,296 @@
+/**
+ * @file test_lcd.c
+ *
+ * @brief Tests of the LCD driver on the host.
+ * @details The 4-bit driver in LCD4.c and the screen updates in LCD.c run
+ * against the HD44780 model in hd44780.c. The tests check what ends up in
+ * the display RAM, and that no timing limit or busy time is broken. Build
+ * with LCD_ROWS and LCD_COLS set to test a 20x4 display.
+ *
+ * @author K. Joseph Hass
+ * @date Created: 2026-10-20T11:48:12-0400
+ * @date Last modified: 2026-10-20T11:48:12-0400
+ *
+ * @copyright Copyright (C) 2026 Kenneth Joseph Hass
+ *
+ * @copyright This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "LPC11xx.h"
+#include "charger.h"
+#include "LCD.h"
+#include "hd44780.h"
+#include "check.h"
+
+//
+// Time taken by the rest of the main loop between calls of LCD_Poll()
+//
+#define MAIN_LOOP_NS  5000
+
+static char Text[LCD_COLS + 1];
+
+static const char *ScreenRow(uint32_t row)
+{
+  HD44780_Row(row, Text);
+  return Text;
+}
+
+static const char *DraftRow(uint32_t row)
+{
+  static char draft[LCD_COLS + 1];
+
+  memcpy(draft, DisplayLines[row], LCD_COLS);
+  draft[LCD_COLS] = '\0';
+  return draft;
+}
+
+static void SetRow(uint32_t row, const char *text)
+{
+  memset(DisplayLines[row], ' ', LCD_COLS);
+  memcpy(DisplayLines[row], text, strlen(text));
+}
+
+/*
+ * Call LCD_Poll() as the main loop does until the LCD has been idle for
+ * longer than its slowest command, and return the time that took in
+ * microseconds, up to the last write
+ */
+static uint32_t Flush(void)
+{
+  uint64_t start = HD44780.Cycles;
+  uint64_t last = start;
+  uint32_t writes = HD44780.Commands + HD44780.Characters;
+
+  while ((HD44780.Cycles - last) * 1000000000 / SystemCoreClock <
+         2 * HD44780_CLEAR_NS) {
+    LCD_Poll();
+    if (writes != HD44780.Commands + HD44780.Characters) {
+      writes = HD44780.Commands + HD44780.Characters;
+      last = HD44780.Cycles;
+    }
+    HD44780_Wait(MAIN_LOOP_NS);
+  }
+  return (last - start) * 1000000 / SystemCoreClock;
+}
+
+static void CheckScreen(void)
+{
+  uint32_t row;
+
+  for (row = 0; row < LCD_ROWS; row++)
+    CHECK_STR(ScreenRow(row), DraftRow(row));
+}
+
+static void TestInit(void)
+{
+  uint32_t code, line;
+
+  HD44780_Init();
+  LCD_Init();
+  CHECK(HD44780.FourBit);
+  CHECK(HD44780.TwoLines);
+  CHECK(HD44780.DisplayOn);
+  CHECK_EQ(HD44780.EntryMode, 0x2);
+  CHECK_EQ(HD44780.Address, 0);
+  CHECK(!HD44780.InCGRAM);
+  // Three resets and the 4-bit switch, then five commands
+  CHECK_EQ(HD44780.Commands, 4 + 5);
+  // The bar graph characters, with 1 to 4 columns lit from the left
+  CHECK_EQ(HD44780.Characters, 4 * 8);
+  for (code = 1; code < LCD_BAR_STEPS; code++) {
+    for (line = 0; line < 7; line++)
+      CHECK_EQ(HD44780.CGRAM[8 * code + line], (0x1F << (5 - code)) & 0x1F);
+    CHECK_EQ(HD44780.CGRAM[8 * code + 7], 0);
+  }
+  // The power-up garbage is gone
+  CheckScreen();
+  CHECK_EQ(HD44780_ErrorCount(), 0);
+}
+
+static void TestPublish(void)
+{
+  uint32_t row, col, blank, us, characters, commands;
+
+  HD44780_Init();
+  LCD_Init();
+  SetRow(0, "Bulk charging");
+  SetRow(1, "14.4V 2.5A  25 C");
+#if LCD_ROWS == 4
+  SetRow(2, "Charge 1234 mAh");
+  SetRow(3, "Time 01:23:45");
+#endif
+
+  // Nothing is shown until the text is published
+  LCD_Poll();
+  CHECK_EQ(strspn(ScreenRow(0), " "), LCD_COLS);
+  LCD_Publish();
+  characters = HD44780.Characters;
+  us = Flush();
+  CheckScreen();
+
+  // Only the characters that are not blank were written
+  for (row = 0, blank = 0; row < LCD_ROWS; row++)
+    for (col = 0; col < LCD_COLS; col++)
+      blank += (' ' == DisplayLines[row][col]);
+  CHECK_EQ(HD44780.Characters - characters, LCD_ROWS * LCD_COLS - blank);
+  printf("%ux%u screen written in %u us\n", LCD_COLS, LCD_ROWS,
+         (unsigned) us);
+
+  // A change of one character costs one address command and one write
+  characters = HD44780.Characters;
+  commands = HD44780.Commands;
+  DisplayLines[1][3] = '5';
+  LCD_Publish();
+  Flush();
+  CheckScreen();
+  CHECK_EQ(HD44780.Characters - characters, 1);
+  CHECK_EQ(HD44780.Commands - commands, 1);
+  CHECK_EQ(HD44780_ErrorCount(), 0);
+  HD44780_Print();
+}
+
+static void TestFrames(void)
+{
+  HD44780_Init();
+  LCD_Init();
+
+  // Two more frames are published while the first is being written, and
+  // the newest one is what the LCD ends up showing
+  SetRow(0, "First");
+  LCD_Publish();
+  LCD_Poll();
+  HD44780_Wait(MAIN_LOOP_NS);
+  LCD_Poll();
+  HD44780_Wait(MAIN_LOOP_NS);
+  SetRow(0, "Second");
+  LCD_Publish();
+  SetRow(0, "Third");
+  LCD_Publish();
+  Flush();
+  CHECK_STR(ScreenRow(0), DraftRow(0));
+  CHECK_EQ(HD44780_ErrorCount(), 0);
+}
+
+static void TestBar(void)
+{
+  uint32_t i;
+
+  HD44780_Init();
+  LCD_Init();
+  SetRow(1, "");
+  LCD_Bar(DisplayLines[1], 4, 2 * LCD_BAR_STEPS + 3);
+  LCD_Publish();
+  Flush();
+  CHECK_EQ((uint8_t) ScreenRow(1)[0], 0xFF);
+  CHECK_EQ((uint8_t) ScreenRow(1)[1], 0xFF);
+  CHECK_EQ(ScreenRow(1)[2], 3);
+  CHECK_EQ(ScreenRow(1)[3], ' ');
+  for (i = 4; i < LCD_COLS; i++)
+    CHECK_EQ(ScreenRow(1)[i], ' ');
+  CHECK_EQ(HD44780_ErrorCount(), 0);
+}
+
+/*
+ * LCD_WriteNextChar() does not check the busy flag, so it relies on the
+ * time between calls
+ */
+static void TestWriteNextChar(void)
+{
+  uint32_t i;
+
+  HD44780_Init();
+  LCD_Init();
+  SetRow(0, "ABCD");
+  LCD_Publish();
+  for (i = 0; i < 8; i++) {
+    LCD_WriteNextChar();
+    HD44780_Wait(HD44780_EXEC_NS);
+  }
+  CHECK_STR(ScreenRow(0), DraftRow(0));
+  CHECK_EQ(HD44780.BusyErrors, 0);
+
+  // Calls with no time between them overrun the LCD, and the model sees it
+  SetRow(0, "WXYZ");
+  LCD_Publish();
+  for (i = 0; i < 8; i++)
+    LCD_WriteNextChar();
+  CHECK(HD44780.BusyErrors > 0);
+}
+
+static void TestTiming(void)
+{
+  HD44780_Init();
+  LCD_Init();
+  SetRow(0, "Timing");
+  LCD_Publish();
+  Flush();
+  CHECK_EQ(HD44780_ErrorCount(), 0);
+  printf("At %u MHz, shortest tAS %u ns (%u), tDS %u ns (%u), "
+         "hold %u ns (%u),\n  tEH %u ns (%u), tEL %u ns (%u), "
+         "read %u ns after EN (%u)\n",
+         (unsigned) (SystemCoreClock / 1000000),
+         HD44780.Min.Setup, LCD_TAS, HD44780.Min.DataSetup, LCD_TDS,
+         HD44780.Min.Hold, HD44780_TH, HD44780.Min.High, LCD_TEH,
+         HD44780.Min.Low, LCD_TEL, HD44780.Min.Read, LCD_TDA);
+
+  // The delays follow the clock, so the slow internal oscillator works too
+  SystemCoreClock = 12000000;
+  HD44780_Init();
+  LCD_Init();
+  LCD_Publish();
+  Flush();
+  CheckScreen();
+  CHECK_EQ(HD44780_ErrorCount(), 0);
+
+  // But they are not changed if the clock is, and the model sees that
+  SystemCoreClock = 48000000;
+  SetRow(0, "Too fast");
+  LCD_Publish();
+  Flush();
+  CHECK(HD44780.Errors.High > 0);
+  CHECK(HD44780.Errors.Low > 0);
+}
+
+/*
+ * A busy flag read with a single enable pulse, as the driver once did,
+ * leaves the LCD expecting the second nibble
+ */
+static void TestHalfRead(void)
+{
+  HD44780_Init();
+  LCD_Init();
+  LPC_GPIO0->DIR &= ~(0xF << LCD_DATA_Pos);
+  LPC_GPIO0->MASKED_ACCESS[0x7 << LCD_CTRL_Pos] = 2 << LCD_CTRL_Pos;
+  HD44780_Wait(LCD_TAS);
+  LPC_GPIO0->MASKED_ACCESS[0x7 << LCD_CTRL_Pos] = 6 << LCD_CTRL_Pos;
+  HD44780_Wait(LCD_TEH);
+  LPC_GPIO0->MASKED_ACCESS[0x7 << LCD_CTRL_Pos] = 2 << LCD_CTRL_Pos;
+  HD44780_Wait(LCD_TEL);
+  LPC_GPIO0->MASKED_ACCESS[0x7 << LCD_CTRL_Pos] = 0;
+  LPC_GPIO0->DIR |= 0xF << LCD_DATA_Pos;
+  HD44780_Wait(LCD_TEL);
+  LCD_WriteDataNoWait('A');
+  CHECK_EQ(HD44780.StepErrors, 1);
+}
+
+int main(void)
+{
+  TestInit();
+  TestPublish();
+  TestFrames();
+  TestBar();
+  TestWriteNextChar();
+  TestTiming();
+  TestHalfRead();
+  return CheckSummary(LCD_ROWS == 4 ? "test_lcd_20x4" : "test_lcd");
+}
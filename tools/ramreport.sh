@@ -0,0 +1,52 @@
+#!/bin/sh
+#
+# ramreport.sh - Report how RAM is used by a linked charger image.
+#
+# Usage: tools/ramreport.sh [charger.elf]
+#
+# Lists the size of each RAM section, the largest variables, and the space
+# left between the end of the static variables and the reserved stack. Set
+# CROSS_COMPILE if the ARM binutils have a different prefix.
+#
+# Compare the reserved stack size shown here with the StackPeak variable,
+# read with the debugger after the charger has been running under load.
+#
+ELF=${1:-charger.elf}
+PREFIX=${CROSS_COMPILE:-arm-none-eabi-}
+NM=${PREFIX}nm
+SIZE=${PREFIX}size
+
+if [ ! -f "$ELF" ]; then
+  echo "usage: $0 [charger.elf]" >&2
+  exit 1
+fi
+
+symbol() {
+  $NM "$ELF" | awk -v name="$1" '$3 == name { print "0x" $1 }'
+}
+
+echo "RAM sections:"
+$SIZE -A -d "$ELF" | awk '$1 ~ /^\.(data|bss|noinit|heap|stack)/ {
+  printf "  %-14s %6d bytes at 0x%08x\n", $1, $2, $3 }'
+
+echo
+echo "Largest RAM variables:"
+$NM --size-sort -S -t d "$ELF" | awk '$3 ~ /^[bBdD]$/ {
+  printf "  %6d  %s\n", $2, $4 }' | sort -rn | head -20
+
+DATA_START=$(symbol __data_start__)
+BSS_END=$(symbol __bss_end__)
+STACK_LIMIT=$(symbol __StackLimit)
+STACK_TOP=$(symbol __StackTop)
+
+echo
+if [ -n "$DATA_START" ] && [ -n "$BSS_END" ] && \
+   [ -n "$STACK_LIMIT" ] && [ -n "$STACK_TOP" ]; then
+  echo "Static variables: $((BSS_END - DATA_START)) bytes"
+  echo "Unused RAM:       $((STACK_LIMIT - BSS_END)) bytes"
+  echo "Reserved stack:   $((STACK_TOP - STACK_LIMIT)) bytes"
+  echo "Total RAM:        $((STACK_TOP - DATA_START)) bytes"
+else
+  echo "Linker symbols not found, cannot compute stack margin" >&2
+  exit 1
+fi